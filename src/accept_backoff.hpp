@@ -0,0 +1,44 @@
+#pragma once
+#include <websocketpp/common/asio.hpp>
+
+#include <algorithm>
+#include <chrono>
+
+// Wartezeit vor dem nächsten accept nach einem Fehler (z. B. EMFILE, keine
+// freien Dateideskriptoren). Sofort neu zu warten würde den Thread mit
+// fehlschlagenden accept-Aufrufen auslasten. Die Pause verdoppelt sich bis
+// max_delay und beginnt nach einer erfolgreichen Annahme wieder bei min_delay.
+// Läuft auf dem io_service des Listeners, also ohne Sperren.
+class AcceptBackoff {
+public:
+    using io_service_t = websocketpp::lib::asio::io_service;
+
+    static constexpr std::chrono::milliseconds min_delay{50};
+    static constexpr std::chrono::milliseconds max_delay{2000};
+
+    explicit AcceptBackoff(io_service_t& io) : m_timer(io) {}
+
+    // Ruft fn nach der aktuellen Pause auf (nicht, wenn vorher cancel() kommt)
+    template <typename Fn>
+    void retry(Fn fn) {
+        m_delay = m_delay.count() == 0 ? min_delay : std::min(m_delay * 2, max_delay);
+        m_timer.expires_from_now(m_delay);
+        m_timer.async_wait([fn](const websocketpp::lib::asio::error_code& ec) {
+            if (!ec) fn();
+        });
+    }
+
+    void reset() { m_delay = std::chrono::milliseconds(0); }
+
+    void cancel() {
+        websocketpp::lib::asio::error_code ec;
+        m_timer.cancel(ec);
+        reset();
+    }
+
+    std::chrono::milliseconds delay() const { return m_delay; }
+
+private:
+    websocketpp::lib::asio::steady_timer m_timer;
+    std::chrono::milliseconds m_delay{0};
+};
@@ -3,7 +3,9 @@
 #include <windows.h>
 #include <filesystem>
 #include <fstream>
+#include <sstream>
 #include <string>
+#include <vector>
 
 // Globale Konfigurationsinstanz
 PluginConfig g_plugin_config;
@@ -29,8 +31,22 @@ static std::string trim(const std::string& str) {
     return str.substr(first, (last - first + 1));
 }
 
+// Hilfsfunktion für boolesche INI-Werte (1/true/yes/on)
+static bool parse_bool(const std::string& value) {
+    return value == "1" || value == "true" || value == "yes" || value == "on";
+}
+
+// Hilfsfunktion für Ganzzahlen; bei ungültigem Wert bleibt der Standard erhalten
+static void parse_int(const std::string& key, const std::string& value, int& out) {
+    try {
+        out = std::stoi(value);
+    } catch (...) {
+        PLOG_WARN(config, "Invalid %s value '%s'. Using default.", key.c_str(), value.c_str());
+    }
+}
+
 PluginConfig load_plugin_config() {
-    plugin_log_printf("[Config] Loading configuration...");
+    PLOG_DEBUG(config, "Loading configuration...");
     PluginConfig cfg;
     cfg.port = 9995; // Standard-Port
     cfg.mode = "default_fallback"; // Eindeutiger Standard-Modus
@@ -39,15 +55,16 @@ PluginConfig load_plugin_config() {
     auto dll_dir = get_dll_directory();
     if (!dll_dir.empty()) {
         search_paths.push_back(dll_dir / "scs_ws_plugin.ini");
+        cfg.trace_file = (dll_dir / cfg.trace_file).string();
     }
     // Man könnte hier weitere Fallback-Pfade hinzufügen, z.B. das CWD
     // search_paths.push_back(std::filesystem::current_path() / "scs_ws_plugin.ini");
 
     for (const auto& path : search_paths) {
-        plugin_log_printf("[Config] Checking for INI at: %s", path.string().c_str());
+        PLOG_DEBUG(config, "Checking for INI at: %s", path.string().c_str());
         std::ifstream file(path);
         if (file.is_open()) {
-            plugin_log_printf("[Config] Found INI file at: %s", path.string().c_str());
+            PLOG_INFO(config, "Found INI file at: %s", path.string().c_str());
             cfg.ini_path_used = path.string();
             std::string line;
             while (std::getline(file, line)) {
@@ -60,24 +77,147 @@ PluginConfig load_plugin_config() {
                 if (equals_pos != std::string::npos) {
                     std::string key = trim(line.substr(0, equals_pos));
                     std::string value = trim(line.substr(equals_pos + 1));
-                    plugin_log_printf("[Config] Read key='%s', value='%s'", key.c_str(), value.c_str());
+                    PLOG_DEBUG(config, "Read key='%s', value='%s'", key.c_str(), value.c_str());
 
                     if (key == "port") {
                         try {
                             cfg.port = std::stoi(value);
                         } catch (...) {
-                            plugin_log_printf("[Config] WARN: Invalid port value '%s'. Using default.", value.c_str());
+                            PLOG_WARN(config, "Invalid port value '%s'. Using default.", value.c_str());
                         }
                     } else if (key == "mode") {
                         cfg.mode = value;
+                    } else if (key == "udp_enabled") {
+                        cfg.udp_enabled = parse_bool(value);
+                    } else if (key == "udp_targets") {
+                        std::stringstream ss(value);
+                        std::string target;
+                        while (std::getline(ss, target, ',')) {
+                            target = trim(target);
+                            if (!target.empty()) cfg.udp_targets.push_back(target);
+                        }
+                    } else if (key == "udp_format") {
+                        if (value == "json" || value == "msgpack") {
+                            cfg.udp_format = value;
+                        } else {
+                            PLOG_WARN(config, "Invalid udp_format '%s'. Using '%s'.", value.c_str(), cfg.udp_format.c_str());
+                        }
+                    } else if (key == "udp_multicast_ttl") {
+                        parse_int(key, value, cfg.udp_multicast_ttl);
+                    } else if (key == "shm_enabled") {
+                        cfg.shm_enabled = parse_bool(value);
+                    } else if (key == "shm_name") {
+                        if (!value.empty()) cfg.shm_name = value;
+                    } else if (key == "shm_slots") {
+                        parse_int(key, value, cfg.shm_slots);
+                    } else if (key == "shm_slot_size") {
+                        parse_int(key, value, cfg.shm_slot_size);
+                    } else if (key == "shm_snapshot_size") {
+                        parse_int(key, value, cfg.shm_snapshot_size);
+                    } else if (key == "stream_tcp_port") {
+                        parse_int(key, value, cfg.stream_tcp_port);
+                    } else if (key == "stream_bind") {
+                        if (!value.empty()) cfg.stream_bind = value;
+                    } else if (key == "stream_unix_path") {
+                        cfg.stream_unix_path = value;
+                    } else if (key == "stream_format") {
+                        if (value == "ndjson" || value == "binary") {
+                            cfg.stream_format = value;
+                        } else {
+                            PLOG_WARN(config, "Invalid stream_format '%s'. Using '%s'.", value.c_str(), cfg.stream_format.c_str());
+                        }
+                    } else if (key == "queue_capacity") {
+                        parse_int(key, value, cfg.queue_capacity);
+                    } else if (key == "queue_overflow") {
+                        if (value == "drop_oldest" || value == "drop_newest") {
+                            cfg.queue_overflow = value;
+                        } else {
+                            PLOG_WARN(config, "Invalid queue_overflow '%s'. Using '%s'.", value.c_str(), cfg.queue_overflow.c_str());
+                        }
+                    } else if (key == "ping_interval_ms") {
+                        parse_int(key, value, cfg.ping_interval_ms);
+                    } else if (key == "metrics_enabled") {
+                        cfg.metrics_enabled = parse_bool(value);
+                    } else if (key == "clients_enabled") {
+                        cfg.clients_enabled = parse_bool(value);
+                    } else if (key == "frame_budget_us") {
+                        parse_int(key, value, cfg.frame_budget_us);
+                    } else if (key == "max_connections") {
+                        parse_int(key, value, cfg.max_connections);
+                    } else if (key == "max_connection_buffer_kb") {
+                        parse_int(key, value, cfg.max_connection_buffer_kb);
+                    } else if (key == "max_total_buffer_kb") {
+                        parse_int(key, value, cfg.max_total_buffer_kb);
+                    } else if (key == "buffer_limit_policy") {
+                        if (value == "degrade" || value == "disconnect") {
+                            cfg.buffer_limit_policy = value;
+                        } else {
+                            PLOG_WARN(config, "Invalid buffer_limit_policy '%s'. Using '%s'.", value.c_str(), cfg.buffer_limit_policy.c_str());
+                        }
+                    } else if (key == "journal_size") {
+                        parse_int(key, value, cfg.journal_size);
+                    } else if (key == "journal_file") {
+                        std::filesystem::path journal_path(value);
+                        if (!value.empty() && journal_path.is_relative() && !dll_dir.empty()) {
+                            journal_path = dll_dir / journal_path;
+                        }
+                        cfg.journal_file = journal_path.string();
+                    } else if (key == "trace_enabled") {
+                        cfg.trace_enabled = parse_bool(value);
+                    } else if (key == "trace_at_start_ms") {
+                        parse_int(key, value, cfg.trace_at_start_ms);
+                    } else if (key == "trace_file" && !value.empty()) {
+                        std::filesystem::path trace_path(value);
+                        if (trace_path.is_relative() && !dll_dir.empty()) {
+                            trace_path = dll_dir / trace_path;
+                        }
+                        cfg.trace_file = trace_path.string();
+                    } else if (key == "usage_interval_s") {
+                        parse_int(key, value, cfg.usage_interval_s);
+                    } else if (key == "ws_threads") {
+                        parse_int(key, value, cfg.ws_threads);
+                    } else if (key == "ws_thread_affinity") {
+                        try {
+                            cfg.ws_thread_affinity = std::stoull(value, nullptr, 0);
+                        } catch (...) {
+                            PLOG_WARN(config, "Invalid %s value '%s'. Using default.", key.c_str(), value.c_str());
+                        }
+                    } else if (key == "log_level") {
+                        if (!plugin_log_parse_level(value, cfg.log_level)) {
+                            PLOG_WARN(config, "Invalid log_level '%s'. Using '%s'.", value.c_str(), plugin_log_level_name(cfg.log_level));
+                        }
+                    } else if (key == "log_format") {
+                        if (value == "text" || value == "binary") {
+                            cfg.log_format = value;
+                        } else {
+                            PLOG_WARN(config, "Invalid log_format '%s'. Using '%s'.", value.c_str(), cfg.log_format.c_str());
+                        }
+                    } else if (key == "log_max_size_kb") {
+                        parse_int(key, value, cfg.log_max_size_kb);
+                    } else if (key == "log_keep") {
+                        parse_int(key, value, cfg.log_keep);
+                    } else if (key.compare(0, 10, "log_level_") == 0) {
+                        LogTag tag;
+                        LogLevel level;
+                        if (plugin_log_parse_tag(key.substr(10), tag) && plugin_log_parse_level(value, level)) {
+                            cfg.log_tag_levels.emplace_back(tag, level);
+                        } else {
+                            PLOG_WARN(config, "Invalid %s value '%s'. Ignoring.", key.c_str(), value.c_str());
+                        }
+                    } else if (key == "shm_format") {
+                        if (value == "json" || value == "msgpack") {
+                            cfg.shm_format = value;
+                        } else {
+                            PLOG_WARN(config, "Invalid shm_format '%s'. Using '%s'.", value.c_str(), cfg.shm_format.c_str());
+                        }
                     }
                 }
             }
-            plugin_log_printf("[Config] Final loaded config: port=%d, mode='%s'", cfg.port, cfg.mode.c_str());
+            PLOG_INFO(config, "Final loaded config: port=%d, mode='%s'", cfg.port, cfg.mode.c_str());
             return cfg; // Wichtig: Beende die Suche nach dem ersten Fund
         }
     }
 
-    plugin_log_printf("[Config] No INI file found. Using default config: port=%d, mode='%s'", cfg.port, cfg.mode.c_str());
+    PLOG_INFO(config, "No INI file found. Using default config: port=%d, mode='%s'", cfg.port, cfg.mode.c_str());
     return cfg;
 }
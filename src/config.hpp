@@ -1,11 +1,79 @@
 #pragma once
 
+#include "plugin_log.hpp"
+
 #include <string>
+#include <utility>
+#include <vector>
 
 struct PluginConfig {
     int port = 9995;              // default
     std::string mode = "delta";   // "delta" oder "full"
     std::string ini_path_used;    // Pfad zur verwendeten INI (leer falls nicht vorhanden)
+
+    // Optionaler UDP-Ausgang (ein Datagramm pro Frame, keine Wiederholung)
+    bool udp_enabled = false;
+    std::vector<std::string> udp_targets; // "host:port", Unicast oder Multicast
+    std::string udp_format = "json";      // "json" oder "msgpack"
+    int udp_multicast_ttl = 1;
+
+    // Optionaler Shared-Memory-Ring für Programme auf demselben Rechner
+    bool shm_enabled = false;
+    std::string shm_name = "scs_ws_ring";
+    int shm_slots = 64;                   // wird auf Zweierpotenz aufgerundet
+    int shm_slot_size = 16384;            // Bytes pro Frame
+    int shm_snapshot_size = 262144;       // Bytes für den letzten vollständigen Zustand
+    std::string shm_format = "json";      // "json" oder "msgpack"
+
+    // Optionaler Einweg-Stream ohne WebSocket (rohes TCP und/oder Unix-Domain-Socket)
+    int stream_tcp_port = 0;              // 0 = aus
+    std::string stream_bind = "127.0.0.1";
+    std::string stream_unix_path;         // leer = aus
+    std::string stream_format = "ndjson"; // "ndjson" oder "binary" (Länge + MessagePack)
+
+    // Warteschlange zwischen Spiel- und Server-Thread
+    int queue_capacity = 1024;                  // wird auf Zweierpotenz aufgerundet
+    std::string queue_overflow = "drop_oldest"; // "drop_oldest" oder "drop_newest" (Ereignisse gehen nie verloren)
+
+    // WebSocket-Ping an jede Verbindung zur Laufzeitmessung
+    int ping_interval_ms = 2000;                // 0 = aus
+
+    // Grenzen gegen Clients, die den Spielprozess mit Verbindungen oder Sendepuffern fluten (0 = unbegrenzt)
+    int max_connections = 64;                   // WebSocket + SSE; darüber HTTP 503
+    int max_connection_buffer_kb = 2048;        // wartende Sendedaten pro Verbindung
+    int max_total_buffer_kb = 32768;            // wartende Sendedaten aller Verbindungen
+    std::string buffer_limit_policy = "degrade"; // "degrade" (erst drosseln, dann trennen) oder "disconnect"
+
+    // Zähler im Prometheus-Format unter GET /metrics
+    bool metrics_enabled = true;
+    // Clients mit Adresse und User-Agent unter GET /clients (der Port lauscht an allen Schnittstellen)
+    bool clients_enabled = false;
+
+    // Zeit pro frame_end im Spiel-Thread; wird sie wiederholt überschritten, veröffentlicht das Plugin seltener
+    int frame_budget_us = 500;                  // 0 = nicht überwachen
+
+    // Chrome/Perfetto-Trace der Pipeline (siehe trace_recorder.hpp)
+    bool trace_enabled = false;                 // Clients dürfen mit {"trace": <ms>} aufzeichnen lassen
+    int trace_at_start_ms = 0;                  // gleich nach dem Start so lange aufzeichnen, 0 = nicht
+    std::string trace_file = "scs_ws_trace.json"; // relativ zum DLL-Ordner
+
+    // CPU-Zeit der Threads und Speicher der Puffer (siehe usage_stats.hpp)
+    int usage_interval_s = 10;                  // {"type":"usage"} an die Clients, 0 = nur beim Beenden ins Log
+
+    // Journal der letzten Ereignisse für Clients, die mit ?since=<seq> wieder verbinden
+    int journal_size = 256;                     // 0 = aus
+    std::string journal_file;                   // optional, NDJSON, relativ zum DLL-Ordner; leer = nur im Speicher
+
+    // WebSocket-Verbindungen auf mehrere io-Threads verteilen (viele Zuschauer)
+    int ws_threads = 1;                         // 1 = alles im Server-Thread, höchstens 16
+    unsigned long long ws_thread_affinity = 0;  // CPU-Maske für die zusätzlichen Threads, 0 = nicht festlegen
+
+    // Log-Schwelle, optional pro Subsystem (log_level_ws=trace usw.)
+    LogLevel log_level = LogLevel::info;
+    std::vector<std::pair<LogTag, LogLevel>> log_tag_levels;
+    std::string log_format = "text";            // "text" oder "binary" (plugin_debug.binlog, tools/log_decode)
+    int log_max_size_kb = 4096;                 // danach rotieren, 0 = nie
+    int log_keep = 3;                           // ältere Dateien (.1 ... .n), die erhalten bleiben
 };
 
 // Lädt die Konfiguration (liest zuerst DLL-Ordner/scs_ws_plugin.ini, dann CWD/scs_ws_plugin.ini, dann Env/Defaults)
@@ -0,0 +1,161 @@
+#pragma once
+#include "encoded_frame.hpp"
+#include "ws_config.hpp"
+
+#include <websocketpp/common/connection_hdl.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Zustand einer WebSocket-Verbindung. Einstellungen werden nur im Server-Thread
+// geändert, die Zähler dürfen von überall gelesen werden.
+struct alignas(64) ConnectionState {
+    using MessagePtr = scs_ws::server_config::message_type::ptr;
+    using Lane = std::deque<MessagePtr, CountingAllocator<MessagePtr, MemoryUse::queues>>;
+
+    websocketpp::connection_hdl hdl;
+    uint64_t id = 0;                       // fortlaufend über alle Shards, für /metrics
+    // Vor dem Eintragen gesetzt und danach unverändert, für /clients
+    std::string remote;
+    std::string user_agent;
+    std::chrono::steady_clock::time_point opened;
+
+    // Beim Broadcast gelesen
+    uint32_t subscriptions = 0xFFFFFFFFu;  // Bit pro MessageKind
+    bool msgpack = false;                  // binär statt JSON-Text
+    uint32_t rate_divisor = 1;             // nur jedes n-te Voll-Frame
+    uint32_t rate_phase = 0;
+    uint64_t replayed_until = 0;           // Ereignisse bis hier kamen schon aus dem Journal
+
+    // Noch nicht an websocketpp übergebene Nachrichten (nur Thread des Shards).
+    // Ereignisse und Konfiguration haben Vorrang und werden nie verworfen,
+    // Frames nur, wenn der Client dauerhaft nicht hinterherkommt.
+    Lane event_lane;
+    Lane frame_lane;
+    size_t lane_bytes = 0;
+
+    // Drosselung bei überschrittenem Puffer-Budget: jede Stufe halbiert die Voll-Frame-Rate
+    uint32_t degrade_level = 0;
+    std::chrono::steady_clock::time_point degraded_at;
+    bool resync_pending = false;           // nach verworfenen Frames mit dem nächsten Snapshot neu aufsetzen
+    bool closing = false;                  // wegen des Budgets getrennt, bekommt nichts mehr
+
+    // Laufzeit über WebSocket-Ping/Pong und Uhrenabgleich (nur Thread des Shards)
+    std::array<uint32_t, 64> rtt_samples{};  // Mikrosekunden, Ringpuffer
+    uint32_t rtt_count = 0;
+    double clock_offset_ms = 0.0;            // Server- minus Client-Uhr
+    bool clock_synced = false;
+
+    // Statistik
+    std::atomic<uint64_t> messages_sent{0};
+    std::atomic<uint64_t> bytes_sent{0};     // Nutzlast
+    std::atomic<uint64_t> wire_bytes_sent{0}; // mit WebSocket-Rahmen (ohne Kompression, die wir nicht aushandeln)
+    std::atomic<uint64_t> messages_skipped{0};
+    std::atomic<uint64_t> frames_dropped{0};
+    std::atomic<uint32_t> rtt_last_us{0};
+    std::atomic<uint64_t> buffered_bytes{0}; // zuletzt gemessen: websocketpp-Puffer plus Spuren
+
+    // Kopie der Einstellungen oben für Leser in anderen Threads (/clients);
+    // der Thread des Shards ruft publish_settings() nach jeder Änderung
+    std::atomic<uint32_t> shown_subscriptions{0xFFFFFFFFu};
+    std::atomic<bool> shown_msgpack{false};
+    std::atomic<uint32_t> shown_rate_divisor{1};
+    std::atomic<uint32_t> shown_degrade_level{0};
+
+    void publish_settings() {
+        shown_subscriptions.store(subscriptions, std::memory_order_relaxed);
+        shown_msgpack.store(msgpack, std::memory_order_relaxed);
+        shown_rate_divisor.store(rate_divisor, std::memory_order_relaxed);
+        shown_degrade_level.store(degrade_level, std::memory_order_relaxed);
+    }
+
+    void add_rtt(uint32_t us) {
+        rtt_samples[rtt_count++ % rtt_samples.size()] = us;
+        rtt_last_us.store(us, std::memory_order_relaxed);
+    }
+
+    // Perzentil (0..1) der letzten Messungen in Mikrosekunden, 0 ohne Messung
+    uint32_t rtt_percentile(double p) const {
+        size_t n = std::min<size_t>(rtt_count, rtt_samples.size());
+        if (n == 0) return 0;
+        std::array<uint32_t, 64> sorted = rtt_samples;
+        std::sort(sorted.begin(), sorted.begin() + n);
+        return sorted[static_cast<size_t>(p * (n - 1) + 0.5)];
+    }
+
+    bool wants(MessageKind kind) const {
+        return (subscriptions >> static_cast<uint32_t>(kind)) & 1u;
+    }
+};
+
+// Liste der offenen Verbindungen als unveränderlicher, referenzgezählter Vektor.
+// Öffnen und Schließen tauschen den Vektor aus (copy-on-write). Schreiber und die
+// Leser beim Senden laufen alle im Thread des Shards und nehmen die lokale Kopie
+// ohne Sperre. Nur für Leser in anderen Threads (/metrics, /clients) wird jede
+// neue Liste zusätzlich atomar veröffentlicht; std::atomic_load auf shared_ptr
+// sperrt intern, deshalb nur dort.
+class ConnectionRegistry {
+public:
+    using List = std::vector<std::shared_ptr<ConnectionState>>;
+    using ListPtr = std::shared_ptr<const List>;
+
+    ConnectionRegistry() : m_local(std::make_shared<const List>()), m_shared(m_local) {}
+
+    // Nur im Thread des Shards
+    ListPtr snapshot() const { return m_local; }
+
+    // Aus beliebigen Threads
+    ListPtr shared_snapshot() const {
+        return std::atomic_load_explicit(&m_shared, std::memory_order_acquire);
+    }
+
+    std::shared_ptr<ConnectionState> add(websocketpp::connection_hdl hdl, uint64_t id, std::string remote,
+                                         std::string user_agent) {
+        auto state = std::make_shared<ConnectionState>();
+        state->hdl = hdl;
+        state->id = id;
+        state->remote = std::move(remote);
+        state->user_agent = std::move(user_agent);
+        state->opened = std::chrono::steady_clock::now();
+        auto next = std::make_shared<List>(*m_local);
+        next->push_back(state);
+        publish(std::move(next));
+        return state;
+    }
+
+    void remove(const websocketpp::connection_hdl& hdl) {
+        auto next = std::make_shared<List>();
+        next->reserve(m_local->size());
+        for (const auto& state : *m_local) {
+            if (!same(state->hdl, hdl)) next->push_back(state);
+        }
+        publish(std::move(next));
+    }
+
+    std::shared_ptr<ConnectionState> find(const websocketpp::connection_hdl& hdl) const {
+        for (const auto& state : *m_local) {
+            if (same(state->hdl, hdl)) return state;
+        }
+        return nullptr;
+    }
+
+private:
+    static bool same(const websocketpp::connection_hdl& a, const websocketpp::connection_hdl& b) {
+        return !a.owner_before(b) && !b.owner_before(a);
+    }
+
+    void publish(std::shared_ptr<List> next) {
+        m_local = std::move(next);
+        std::atomic_store_explicit(&m_shared, m_local, std::memory_order_release);
+    }
+
+    ListPtr m_local;  // nur Thread des Shards
+    ListPtr m_shared; // nur über atomic_load/atomic_store
+};
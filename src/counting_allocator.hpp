@@ -0,0 +1,65 @@
+#pragma once
+// Zählt den Heap-Speicher, den das Plugin für eigene Container und Nachrichtenpuffer
+// anfordert (aktuell, Höchststand, Anzahl), getrennt nach Verwendung. Die Zähler
+// sind relaxed atomics und werden in usage_stats ausgewertet.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+enum class MemoryUse : uint8_t {
+    frames,   // kodierte Nachrichten (EncodedFrame)
+    state,    // Telemetrie-Zustand im Plugin
+    queues,   // Sende-Spuren der Verbindungen (ohne Nutzdaten, die zählen als buffered_bytes)
+    count
+};
+
+struct MemoryCounter {
+    std::atomic<int64_t> current{0};
+    std::atomic<int64_t> peak{0};
+    std::atomic<uint64_t> allocations{0};
+};
+
+extern MemoryCounter g_memory[static_cast<size_t>(MemoryUse::count)];
+
+void memory_note_peak(MemoryCounter& counter, int64_t current);
+
+inline void memory_add(MemoryUse use, size_t bytes) {
+    MemoryCounter& counter = g_memory[static_cast<size_t>(use)];
+    counter.allocations.fetch_add(1, std::memory_order_relaxed);
+    int64_t current = counter.current.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed) + static_cast<int64_t>(bytes);
+    if (current > counter.peak.load(std::memory_order_relaxed)) memory_note_peak(counter, current);
+}
+
+inline void memory_sub(MemoryUse use, size_t bytes) {
+    g_memory[static_cast<size_t>(use)].current.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+}
+
+// std-Allocator, der jede Anforderung unter Use mitzählt
+template <class T, MemoryUse Use>
+struct CountingAllocator {
+    using value_type = T;
+
+    template <class U>
+    struct rebind {
+        using other = CountingAllocator<U, Use>;
+    };
+
+    CountingAllocator() noexcept = default;
+    template <class U>
+    CountingAllocator(const CountingAllocator<U, Use>&) noexcept {}
+
+    T* allocate(size_t n) {
+        T* p = std::allocator<T>().allocate(n);
+        memory_add(Use, n * sizeof(T));
+        return p;
+    }
+    void deallocate(T* p, size_t n) noexcept {
+        memory_sub(Use, n * sizeof(T));
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    friend bool operator==(const CountingAllocator&, const CountingAllocator&) { return true; }
+    friend bool operator!=(const CountingAllocator&, const CountingAllocator&) { return false; }
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include "counting_allocator.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Art der Nachricht, die an die Ausgabekanäle (WebSocket, UDP, ...) verteilt wird
+enum class MessageKind : uint8_t {
+    frame = 0,     // Telemetrie-Frame (full/delta/devenv)
+    gameplay = 1,  // Gameplay-Event (job.delivered, player.fined, ...)
+    snapshot = 2,  // Vollständiger Zustand nur für Snapshot-Abnehmer (nicht an Clients)
+    config = 3,    // Konfigurationsänderung (truck, trailer, job, ...)
+    usage = 4,     // Eigenverbrauch des Plugins, vom Server-Thread (nur an WebSocket-Clients)
+};
+
+// Nachrichtenpuffer; ihr Speicher zählt unter MemoryUse::frames
+using FrameBuffer = std::basic_string<char, std::char_traits<char>, CountingAllocator<char, MemoryUse::frames>>;
+
+// Einmal pro Frame kodierte Nachricht. Wird per shared_ptr zwischen allen
+// Ausgabekanälen geteilt, damit nichts mehrfach kodiert oder kopiert wird.
+struct EncodedFrame {
+    uint64_t seq = 0;
+    MessageKind kind = MessageKind::frame;
+    bool full_state = false; // Nutzdaten enthalten den kompletten Zustand (full/devenv/snapshot)
+    FrameBuffer json;     // JSON-Text (immer vorhanden)
+    FrameBuffer msgpack;  // MessagePack (nur befüllt, wenn ein Kanal es benötigt)
+};
+
+using EncodedFramePtr = std::shared_ptr<const EncodedFrame>;
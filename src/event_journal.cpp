@@ -0,0 +1,70 @@
+#include "event_journal.hpp"
+#include "plugin_log.hpp"
+
+#include <algorithm>
+#include <memory>
+
+EventJournal::~EventJournal() {
+    close();
+}
+
+void EventJournal::open(size_t capacity, const std::string& file_path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = capacity;
+    m_entries.clear();
+    m_evicted_seq = 0;
+    m_newest_seq = 0;
+    if (m_file.is_open()) m_file.close();
+    if (capacity == 0 || file_path.empty()) return;
+
+    m_file.open(file_path, std::ios::out | std::ios::app | std::ios::binary);
+    if (m_file.is_open()) {
+        PLOG_INFO(journal, "Mirroring events to %s", file_path.c_str());
+    } else {
+        PLOG_WARN(journal, "Could not open %s, keeping events in memory only.", file_path.c_str());
+    }
+}
+
+void EventJournal::close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_file.is_open()) m_file.close();
+}
+
+void EventJournal::append(const EncodedFrame& frame) {
+    if (m_capacity == 0) return;
+    auto entry = std::make_shared<EncodedFrame>(frame);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_entries.size() >= m_capacity) {
+        m_evicted_seq = m_entries.front()->seq;
+        m_entries.pop_front();
+    }
+    m_entries.push_back(entry);
+    m_newest_seq = std::max(m_newest_seq, entry->seq);
+
+    if (m_file.is_open()) {
+        // Sofort schreiben: die Ereignisse sind selten und sollen einen Absturz überstehen
+        m_file.write(entry->json.data(), static_cast<std::streamsize>(entry->json.size()));
+        m_file.put('\n');
+        m_file.flush();
+    }
+}
+
+void EventJournal::note_seq(uint64_t seq) {
+    if (m_capacity == 0) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_newest_seq = std::max(m_newest_seq, seq);
+}
+
+EventJournal::Replay EventJournal::since(uint64_t seq, std::vector<EncodedFramePtr>& out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Replay replay;
+    replay.reset = seq > m_newest_seq;
+    if (replay.reset) seq = 0;
+    for (const auto& entry : m_entries) {
+        if (entry->seq > seq) out.push_back(entry);
+    }
+    replay.complete = seq >= m_evicted_seq;
+    replay.until = m_entries.empty() ? 0 : m_entries.back()->seq;
+    return replay;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "encoded_frame.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Die letzten Ereignisse (gameplay, config) für Clients, die nach einem
+// Verbindungsabbruch mit since=<seq> weitermachen wollen. Optional wird jedes
+// Ereignis zusätzlich als Zeile an eine NDJSON-Datei angehängt.
+// Gefüllt wird das Journal vom Server-Thread beim Abarbeiten der Warteschlange,
+// gelesen von den Shards beim Verbindungsaufbau; der Spiel-Thread fasst es nie an.
+class EventJournal {
+public:
+    EventJournal() = default;
+    ~EventJournal();
+
+    EventJournal(const EventJournal&) = delete;
+    EventJournal& operator=(const EventJournal&) = delete;
+
+    // capacity 0 schaltet das Journal ab, file_path leer = keine Datei
+    void open(size_t capacity, const std::string& file_path);
+    void close();
+
+    bool enabled() const { return m_capacity > 0; }
+
+    // Nur Ereignisse; das Frame wird kopiert, damit es nicht im Pool festgehalten wird
+    void append(const EncodedFrame& frame);
+
+    // Höchste bisher vergebene seq (auch von Frames), damit since() ein seq aus
+    // einer früheren Sitzung des Spiels erkennt
+    void note_seq(uint64_t seq);
+
+    struct Replay {
+        bool complete = true; // false: dazwischen sind schon Ereignisse aus dem Journal gefallen
+        bool reset = false;   // seq liegt vor uns (Spiel neu gestartet), geliefert wird alles
+        uint64_t until = 0;   // neuestes Ereignis im Journal; spätere kommen live
+    };
+
+    // Hängt alle Ereignisse mit seq > since an out an
+    Replay since(uint64_t seq, std::vector<EncodedFramePtr>& out) const;
+
+private:
+    mutable std::mutex m_mutex; // nur Server-Threads untereinander
+    std::deque<EncodedFramePtr> m_entries;
+    size_t m_capacity = 0;
+    uint64_t m_evicted_seq = 0; // seq des zuletzt verdrängten Eintrags
+    uint64_t m_newest_seq = 0;  // siehe note_seq
+    std::ofstream m_file;
+};
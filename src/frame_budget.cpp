@@ -0,0 +1,57 @@
+#include "frame_budget.hpp"
+#include "plugin_log.hpp"
+#include "plugin_metrics.hpp"
+
+void FrameBudget::configure(uint32_t budget_us, std::chrono::steady_clock::time_point now) {
+    m_budget_ns = static_cast<uint64_t>(budget_us) * 1000;
+    m_level = 0;
+    m_phase = 0;
+    m_window_count = 0;
+    m_window_over = 0;
+    m_calm_since = now;
+    g_metrics.frame_budget_level.store(0, std::memory_order_relaxed);
+}
+
+bool FrameBudget::should_publish() {
+    if (m_level == 0) return true;
+    if ((m_phase++ & ((1u << m_level) - 1)) == 0) return true;
+    g_metrics.frames_coalesced.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void FrameBudget::record(uint64_t ns, std::chrono::steady_clock::time_point now) {
+    if (m_budget_ns == 0) return;
+    if (ns > m_budget_ns) {
+        ++m_window_over;
+        m_calm_since = now;
+        g_metrics.frame_budget_exceeded.fetch_add(1, std::memory_order_relaxed);
+    } else if (m_level > 0 && now - m_calm_since >= calm_time) {
+        --m_level;
+        if (m_level == 0) {
+            PLOG_INFO(plugin, "Back within the frame budget, publishing every frame again.");
+        } else {
+            PLOG_INFO(plugin, "Back within the frame budget, publishing every %u. frame (level %u).", 1u << m_level, m_level);
+        }
+        changed(now);
+        return;
+    }
+    if (++m_window_count < window_frames) return;
+
+    const uint32_t over = m_window_over;
+    m_window_count = 0;
+    m_window_over = 0;
+    if (over >= window_limit && m_level < max_level) {
+        ++m_level;
+        PLOG_WARN(plugin, "Frame budget of %llu us exceeded in %u of %u frames, publishing every %u. frame now (level %u).",
+                  static_cast<unsigned long long>(m_budget_ns / 1000), over, window_frames, 1u << m_level, m_level);
+        changed(now);
+    }
+}
+
+void FrameBudget::changed(std::chrono::steady_clock::time_point now) {
+    m_window_count = 0;
+    m_window_over = 0;
+    m_calm_since = now;
+    g_metrics.frame_budget_level.store(m_level, std::memory_order_relaxed);
+    g_metrics.frame_budget_steps.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// Wacht über die Zeit, die das Plugin pro frame_end im Spiel-Thread verbraucht.
+// Wird das Budget in einem Fenster von 60 veröffentlichten Frames mindestens
+// 15-mal überschritten, steigt die Stufe: ab Stufe n wird nur noch jeder 2^n-te
+// Frame veröffentlicht (Deltas gehen dabei nicht verloren, sie wandern in den
+// nächsten veröffentlichten Frame). Nach 5 s ganz ohne Überschreitung geht es
+// eine Stufe zurück. Nur vom Spiel-Thread benutzen; die Zeitpunkte kommen vom
+// Aufrufer, der sie für die Messung ohnehin hat (und Tests eigene übergeben).
+class FrameBudget {
+public:
+    static constexpr uint32_t max_level = 3;          // höchstens jeder 8. Frame
+    static constexpr uint32_t window_frames = 60;
+    static constexpr uint32_t window_limit = 15;      // Überschreitungen pro Fenster bis zur nächsten Stufe
+    static constexpr std::chrono::seconds calm_time{5}; // ohne Überschreitung bis zur Rückstufung
+
+    // 0 schaltet die Überwachung ab
+    void configure(uint32_t budget_us, std::chrono::steady_clock::time_point now);
+
+    // Vor der Arbeit eines frame_end: false, wenn dieser Frame ausgelassen wird
+    bool should_publish();
+
+    // Danach mit der gemessenen Zeit und ihrem Ende (nur für veröffentlichte Frames)
+    void record(uint64_t ns, std::chrono::steady_clock::time_point now);
+
+    uint32_t level() const { return m_level; }
+    uint64_t budget_ns() const { return m_budget_ns; }
+
+private:
+    void changed(std::chrono::steady_clock::time_point now);
+
+    uint64_t m_budget_ns = 0;
+    uint32_t m_level = 0;
+    uint32_t m_phase = 0;
+    uint32_t m_window_count = 0;
+    uint32_t m_window_over = 0;
+    std::chrono::steady_clock::time_point m_calm_since; // letzte Überschreitung oder letzter Stufenwechsel
+};
@@ -0,0 +1,185 @@
+#include "frame_encoder.hpp"
+
+// Ausgabeadapter, dessen Ziel-String pro Nachricht umgesetzt wird
+class FrameEncoder::TargetAdapter : public nlohmann::detail::output_adapter_protocol<char> {
+public:
+    void write_character(char c) override { m_target->push_back(c); }
+    void write_characters(const char* s, std::size_t length) override { m_target->append(s, length); }
+
+    FrameBuffer* m_target = nullptr;
+};
+
+// Schlüssel und Spielkennung sind praktisch immer einfache Bezeichner
+static bool needs_json_escape(const std::string& s) {
+    for (unsigned char c : s) {
+        if (c < 0x20 || c == '"' || c == '\\' || c >= 0x80) return true;
+    }
+    return false;
+}
+
+FrameEncoder::FrameEncoder() : m_adapter(std::make_shared<TargetAdapter>()) {
+    m_serializer.reset(new nlohmann::detail::serializer<nlohmann::json>(m_adapter, ' '));
+    m_msgpack_writer.reset(new nlohmann::detail::binary_writer<nlohmann::json, char>(m_adapter));
+}
+
+FrameEncoder::~FrameEncoder() = default;
+
+void FrameEncoder::encode(const nlohmann::json& message, bool with_msgpack, EncodedFrame& out) {
+    if (!message.is_object()) {
+        m_adapter->m_target = &out.json;
+        m_serializer->dump(message, false, false, 0);
+        if (with_msgpack) {
+            m_adapter->m_target = &out.msgpack;
+            write_msgpack_value(message);
+        }
+        m_adapter->m_target = nullptr;
+        return;
+    }
+
+    // Objekte bekommen zusätzlich "seq"
+    const nlohmann::json seq_json = out.seq;
+
+    m_adapter->m_target = &out.json;
+    out.json.push_back('{');
+    for (auto it = message.begin(); it != message.end(); ++it) {
+        write_json_key(it.key());
+        m_serializer->dump(it.value(), false, false, 0);
+        out.json.push_back(',');
+    }
+    write_json_key("seq");
+    m_serializer->dump(seq_json, false, false, 0);
+    out.json.push_back('}');
+
+    if (with_msgpack) {
+        m_adapter->m_target = &out.msgpack;
+        write_msgpack_map_header(message.size() + 1);
+        for (auto it = message.begin(); it != message.end(); ++it) {
+            write_msgpack_string(it.key());
+            write_msgpack_value(it.value());
+        }
+        write_msgpack_string("seq");
+        m_msgpack_writer->write_msgpack(seq_json);
+    }
+    m_adapter->m_target = nullptr;
+}
+
+void FrameEncoder::encode_fields(const Field* const* fields, size_t count, int64_t timestamp, const std::string& game,
+                                 bool with_msgpack, EncodedFrame& out) {
+    const nlohmann::json timestamp_json = timestamp;
+    const nlohmann::json seq_json = out.seq;
+
+    m_adapter->m_target = &out.json;
+    out.json.push_back('{');
+    for (size_t i = 0; i < count; ++i) {
+        write_json_key(fields[i]->first);
+        m_serializer->dump(fields[i]->second, false, false, 0);
+        out.json.push_back(',');
+    }
+    write_json_key("timestamp");
+    m_serializer->dump(timestamp_json, false, false, 0);
+    out.json.push_back(',');
+    write_json_key("game");
+    write_json_string(game);
+    out.json.push_back(',');
+    write_json_key("seq");
+    m_serializer->dump(seq_json, false, false, 0);
+    out.json.push_back('}');
+
+    if (with_msgpack) {
+        m_adapter->m_target = &out.msgpack;
+        write_msgpack_map_header(count + 3);
+        for (size_t i = 0; i < count; ++i) {
+            write_msgpack_string(fields[i]->first);
+            write_msgpack_value(fields[i]->second);
+        }
+        write_msgpack_string("timestamp");
+        m_msgpack_writer->write_msgpack(timestamp_json);
+        write_msgpack_string("game");
+        write_msgpack_string(game);
+        write_msgpack_string("seq");
+        m_msgpack_writer->write_msgpack(seq_json);
+    }
+    m_adapter->m_target = nullptr;
+}
+
+void FrameEncoder::write_json_key(const std::string& key) {
+    write_json_string(key);
+    m_adapter->m_target->push_back(':');
+}
+
+void FrameEncoder::write_json_string(const std::string& value) {
+    if (needs_json_escape(value)) {
+        m_serializer->dump(nlohmann::json(value), false, false, 0); // selten, darf allozieren
+        return;
+    }
+    FrameBuffer& target = *m_adapter->m_target;
+    target.push_back('"');
+    target.append(value);
+    target.push_back('"');
+}
+
+// Objekte und Arrays selbst durchlaufen: binary_writer legt für jeden
+// Objektschlüssel ein temporäres JSON-String-Objekt an (Allokation pro Schlüssel)
+void FrameEncoder::write_msgpack_value(const nlohmann::json& value) {
+    if (value.is_object()) {
+        write_msgpack_map_header(value.size());
+        for (auto it = value.begin(); it != value.end(); ++it) {
+            write_msgpack_string(it.key());
+            write_msgpack_value(it.value());
+        }
+    } else if (value.is_array()) {
+        write_msgpack_array_header(value.size());
+        for (const auto& element : value) {
+            write_msgpack_value(element);
+        }
+    } else {
+        m_msgpack_writer->write_msgpack(value);
+    }
+}
+
+void FrameEncoder::write_msgpack_map_header(size_t count) {
+    FrameBuffer& target = *m_adapter->m_target;
+    if (count < 16) {
+        target.push_back(static_cast<char>(0x80 | count));
+    } else if (count <= 0xFFFF) {
+        target.push_back(static_cast<char>(0xDE));
+        target.push_back(static_cast<char>((count >> 8) & 0xFF));
+        target.push_back(static_cast<char>(count & 0xFF));
+    } else {
+        target.push_back(static_cast<char>(0xDF));
+        for (int shift = 24; shift >= 0; shift -= 8) target.push_back(static_cast<char>((count >> shift) & 0xFF));
+    }
+}
+
+void FrameEncoder::write_msgpack_array_header(size_t count) {
+    FrameBuffer& target = *m_adapter->m_target;
+    if (count < 16) {
+        target.push_back(static_cast<char>(0x90 | count));
+    } else if (count <= 0xFFFF) {
+        target.push_back(static_cast<char>(0xDC));
+        target.push_back(static_cast<char>((count >> 8) & 0xFF));
+        target.push_back(static_cast<char>(count & 0xFF));
+    } else {
+        target.push_back(static_cast<char>(0xDD));
+        for (int shift = 24; shift >= 0; shift -= 8) target.push_back(static_cast<char>((count >> shift) & 0xFF));
+    }
+}
+
+void FrameEncoder::write_msgpack_string(const std::string& value) {
+    FrameBuffer& target = *m_adapter->m_target;
+    const size_t len = value.size();
+    if (len < 32) {
+        target.push_back(static_cast<char>(0xA0 | len));
+    } else if (len <= 0xFF) {
+        target.push_back(static_cast<char>(0xD9));
+        target.push_back(static_cast<char>(len));
+    } else if (len <= 0xFFFF) {
+        target.push_back(static_cast<char>(0xDA));
+        target.push_back(static_cast<char>((len >> 8) & 0xFF));
+        target.push_back(static_cast<char>(len & 0xFF));
+    } else {
+        target.push_back(static_cast<char>(0xDB));
+        for (int shift = 24; shift >= 0; shift -= 8) target.push_back(static_cast<char>((len >> shift) & 0xFF));
+    }
+    target.append(value);
+}
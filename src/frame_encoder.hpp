@@ -0,0 +1,44 @@
+#pragma once
+#include "encoded_frame.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Kodiert Nachrichten direkt in die (wiederverwendeten) Puffer eines EncodedFrame.
+// Serializer und MessagePack-Writer werden einmal angelegt und schreiben über
+// einen umlenkbaren Adapter; dadurch entstehen pro Frame keine temporären
+// Strings. Nur vom Spiel-Thread benutzen.
+class FrameEncoder {
+public:
+    using Field = std::map<std::string, nlohmann::json>::value_type;
+
+    FrameEncoder();
+    ~FrameEncoder();
+
+    // Beliebige Nachricht (Ereignisse, Konfiguration); Objekte bekommen "seq" = out.seq
+    void encode(const nlohmann::json& message, bool with_msgpack, EncodedFrame& out);
+
+    // Objekt aus Feldern des Telemetrie-Zustands plus "timestamp", "game" und "seq",
+    // ohne den Zustand dafür in ein temporäres JSON-Objekt zu kopieren
+    void encode_fields(const Field* const* fields, size_t count, int64_t timestamp, const std::string& game,
+                       bool with_msgpack, EncodedFrame& out);
+
+private:
+    class TargetAdapter;
+
+    void write_json_key(const std::string& key);
+    void write_json_string(const std::string& value);
+    void write_msgpack_value(const nlohmann::json& value);
+    void write_msgpack_map_header(size_t count);
+    void write_msgpack_array_header(size_t count);
+    void write_msgpack_string(const std::string& value);
+
+    std::shared_ptr<TargetAdapter> m_adapter;
+    std::unique_ptr<nlohmann::detail::serializer<nlohmann::json>> m_serializer;
+    std::unique_ptr<nlohmann::detail::binary_writer<nlohmann::json, char>> m_msgpack_writer;
+};
@@ -0,0 +1,40 @@
+#include "frame_pool.hpp"
+
+#include <atomic>
+
+FramePool::FramePool(size_t max_frames) : m_max_frames(max_frames) {
+    m_frames.reserve(max_frames);
+}
+
+std::shared_ptr<EncodedFrame> FramePool::acquire() {
+    // Ein Frame ist frei, wenn nur noch der Pool selbst eine Referenz hält
+    const size_t count = m_frames.size();
+    for (size_t i = 0; i < count; ++i) {
+        size_t idx = (m_cursor + i) % count;
+        std::shared_ptr<EncodedFrame>& frame = m_frames[idx];
+        if (frame.use_count() != 1) continue;
+
+        // Die letzte Freigabe (acq_rel) auf einem anderen Thread muss vor unseren Schreibzugriffen liegen
+        std::atomic_thread_fence(std::memory_order_acquire);
+        m_cursor = (idx + 1) % count;
+        frame->seq = 0;
+        frame->kind = MessageKind::frame;
+        frame->full_state = false;
+        frame->json.clear();
+        frame->msgpack.clear();
+        return frame;
+    }
+
+    auto frame = std::make_shared<EncodedFrame>();
+    frame->json.reserve(m_typical_size + m_typical_size / 4);
+    if (m_frames.size() < m_max_frames) {
+        m_frames.push_back(frame);
+    } else {
+        ++m_misses; // Alle Frames unterwegs (Server hängt); dieses wird nicht zurückgegeben
+    }
+    return frame;
+}
+
+void FramePool::note_size(size_t bytes) {
+    m_typical_size = (m_typical_size * 7 + bytes) / 8;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "encoded_frame.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Wiederverwendbare EncodedFrame-Objekte samt ihrer Puffer. Der Pool wächst nur,
+// wenn alle Frames unterwegs sind (Queue, Sende-Queues, SSE-Verlauf).
+// Ein Frame gehört wieder dem Pool, sobald der letzte Ausgang (Queue,
+// WebSocket-Verbindungen, Sinks) seinen Zeiger freigegeben hat; die Strings
+// behalten dabei ihre Kapazität. Neue Frames werden mit der zuletzt
+// typischen Nutzlastgröße vorbelegt. Nur vom Spiel-Thread benutzen.
+class FramePool {
+public:
+    explicit FramePool(size_t max_frames = 1024);
+
+    // Liefert ein leeres Frame; ist der Pool erschöpft, wird ein ungepooltes angelegt
+    std::shared_ptr<EncodedFrame> acquire();
+
+    // Nach dem Kodieren aufrufen, damit neue Frames passend vorbelegt werden
+    void note_size(size_t bytes);
+
+    size_t pooled() const { return m_frames.size(); }
+    uint64_t misses() const { return m_misses; }
+
+private:
+    std::vector<std::shared_ptr<EncodedFrame>> m_frames;
+    size_t m_cursor = 0;
+    size_t m_max_frames;
+    size_t m_typical_size = 4096; // gleitendes Mittel der JSON-Größe
+    uint64_t m_misses = 0;
+};
@@ -0,0 +1,168 @@
+#include "frame_queue.hpp"
+
+#include <algorithm>
+#include <thread>
+
+FrameQueue::FrameQueue(size_t capacity, Overflow policy) : m_policy(policy) {
+    size_t cap = 16;
+    while (cap < capacity) cap <<= 1;
+    m_mask = cap - 1;
+    m_cells.reset(new Cell[cap]);
+    for (size_t i = 0; i < cap; ++i) {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    m_nodes.reset(new OverflowNode[cap]);
+}
+
+FrameQueue::~FrameQueue() {
+    OverflowNode* node = m_overflow.exchange(nullptr);
+    while (node) {
+        OverflowNode* next = node->next;
+        release_node(node);
+        node = next;
+    }
+}
+
+void FrameQueue::push(EncodedFramePtr frame) {
+    if (!frame) return;
+    const bool droppable = is_droppable(*frame);
+
+    for (;;) {
+        if (try_push(frame)) {
+            // Nur eine Schätzung; der Verbraucher kann zwischen den beiden Ladevorgängen weiterlaufen
+            size_t dequeued = m_dequeue_pos.load(std::memory_order_relaxed);
+            size_t enqueued = m_enqueue_pos.load(std::memory_order_relaxed);
+            size_t depth = enqueued > dequeued ? std::min(enqueued - dequeued, capacity()) : 0;
+            size_t high = m_high_water.load(std::memory_order_relaxed);
+            while (depth > high && !m_high_water.compare_exchange_weak(high, depth, std::memory_order_relaxed)) {
+            }
+            return;
+        }
+
+        if (!droppable) {
+            // Ereignis ohne Platz: nicht warten, nicht verdrängen, sondern zurückstellen
+            if (m_policy == Overflow::drop_newest) {
+                push_overflow(std::move(frame));
+                return;
+            }
+        } else if (m_policy == Overflow::drop_newest) {
+            m_frames_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        // drop_oldest: Platz schaffen, indem der Erzeuger den ältesten Eintrag selbst entnimmt.
+        // Solange er ihn in der Hand hat, wartet drain() auf ihn (siehe dort).
+        m_overflow_moving.fetch_add(1, std::memory_order_seq_cst);
+        EncodedFramePtr oldest;
+        if (try_pop(oldest)) {
+            if (is_droppable(*oldest)) {
+                m_frames_dropped.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                push_overflow(std::move(oldest));
+            }
+        }
+        m_overflow_moving.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+// Erst der Ring, dann die Überlaufliste: Ein Ereignis, das ein Erzeuger dem Ring
+// entnommen hat, bevor er leer war, ist älter als alles, was danach im Ring
+// landet. drain() wartet, bis solche Umhängungen fertig sind, und sortiert den
+// ganzen Stapel nach seq - so kommt kein Ereignis erst einen Stapel später an.
+void FrameQueue::drain(std::vector<EncodedFramePtr>& out) {
+    size_t first = out.size();
+    EncodedFramePtr frame;
+    while (try_pop(frame)) {
+        out.push_back(std::move(frame));
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (m_overflow_moving.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+
+    OverflowNode* node = m_overflow.exchange(nullptr, std::memory_order_acquire);
+    if (!node) return;
+    while (node) {
+        OverflowNode* next = node->next;
+        out.push_back(std::move(node->frame));
+        release_node(node);
+        node = next;
+    }
+    std::stable_sort(out.begin() + first, out.end(),
+                     [](const EncodedFramePtr& a, const EncodedFramePtr& b) { return a->seq < b->seq; });
+}
+
+bool FrameQueue::try_push(EncodedFramePtr& frame) {
+    size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &m_cells[pos & m_mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            return false; // voll
+        } else {
+            pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+    cell->frame = std::move(frame);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+// Mehrere Verbraucher möglich (Server-Thread und verdrängende Erzeuger). Release
+// beim Belegen, damit drain() nach dem Lesen der Position m_overflow_moving sieht.
+bool FrameQueue::try_pop(EncodedFramePtr& frame) {
+    size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &m_cells[pos & m_mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            return false; // leer
+        } else {
+            pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+    frame = std::move(cell->frame);
+    cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+    return true;
+}
+
+void FrameQueue::push_overflow(EncodedFramePtr frame) {
+    m_events_overflowed.fetch_add(1, std::memory_order_relaxed);
+    OverflowNode* node = acquire_node();
+    node->frame = std::move(frame);
+    node->next = m_overflow.load(std::memory_order_relaxed);
+    while (!m_overflow.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+}
+
+// Freien Knoten aus dem Vorrat belegen; erst wenn alle in der Liste hängen, wird allokiert
+FrameQueue::OverflowNode* FrameQueue::acquire_node() {
+    const size_t count = capacity();
+    size_t start = m_node_hint.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        OverflowNode& node = m_nodes[(start + i) & m_mask];
+        if (!node.in_use.load(std::memory_order_relaxed) && !node.in_use.exchange(true, std::memory_order_acquire)) {
+            return &node;
+        }
+    }
+    m_overflow_nodes_allocated.fetch_add(1, std::memory_order_relaxed);
+    return new OverflowNode();
+}
+
+void FrameQueue::release_node(OverflowNode* node) {
+    if (node >= m_nodes.get() && node < m_nodes.get() + capacity()) {
+        node->frame.reset();
+        node->in_use.store(false, std::memory_order_release);
+    } else {
+        delete node;
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "encoded_frame.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Begrenzte, sperrfreie Warteschlange zwischen Spiel-Thread(s) und Server-Thread.
+// Ring nach Vyukov (Sequenznummer pro Zelle), die Zellen halten nur den
+// referenzgezählten Zeiger auf das kodierte Frame.
+//
+// Ist der Ring voll, blockiert push() nie:
+//   drop_oldest: der Erzeuger entnimmt selbst den ältesten Eintrag
+//   drop_newest: das neue Frame wird verworfen
+// Ereignisse (gameplay, config) werden in beiden Fällen nie verworfen; wer
+// verdrängt wird oder keinen Platz findet, landet in einer Überlaufliste,
+// die drain() nach dem Ring leert und mit ihm nach seq zusammenführt. Die
+// Knoten der Liste kommen aus einem vorab angelegten Vorrat, damit push()
+// im Spiel-Thread nicht allokiert.
+class FrameQueue {
+public:
+    enum class Overflow { drop_oldest, drop_newest };
+
+    FrameQueue(size_t capacity, Overflow policy);
+    ~FrameQueue();
+
+    FrameQueue(const FrameQueue&) = delete;
+    FrameQueue& operator=(const FrameQueue&) = delete;
+
+    // Beliebige Threads, wartet nie
+    void push(EncodedFramePtr frame);
+
+    // Nur Server-Thread: hängt alle wartenden Nachrichten in Reihenfolge an out an
+    void drain(std::vector<EncodedFramePtr>& out);
+
+    size_t capacity() const { return m_mask + 1; }
+    uint64_t frames_dropped() const { return m_frames_dropped.load(std::memory_order_relaxed); }
+    uint64_t events_overflowed() const { return m_events_overflowed.load(std::memory_order_relaxed); }
+    // Überlaufknoten, die außerhalb des Vorrats angelegt werden mussten
+    uint64_t overflow_nodes_allocated() const { return m_overflow_nodes_allocated.load(std::memory_order_relaxed); }
+    size_t high_water() const { return m_high_water.load(std::memory_order_relaxed); }
+
+    static bool is_droppable(const EncodedFrame& frame) {
+        return frame.kind == MessageKind::frame || frame.kind == MessageKind::snapshot || frame.kind == MessageKind::usage;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        EncodedFramePtr frame;
+    };
+
+    struct OverflowNode {
+        EncodedFramePtr frame;
+        OverflowNode* next = nullptr;
+        std::atomic<bool> in_use{false}; // nur für Knoten aus dem Vorrat
+    };
+
+    bool try_push(EncodedFramePtr& frame);
+    bool try_pop(EncodedFramePtr& frame);
+    void push_overflow(EncodedFramePtr frame);
+    OverflowNode* acquire_node();
+    void release_node(OverflowNode* node);
+
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_mask;
+    Overflow m_policy;
+
+    // Erzeuger- und Verbraucherposition auf getrennten Cache-Lines
+    alignas(64) std::atomic<size_t> m_enqueue_pos{0};
+    alignas(64) std::atomic<size_t> m_dequeue_pos{0};
+    alignas(64) std::atomic<OverflowNode*> m_overflow{nullptr};
+    // Erzeuger, die gerade einen Eintrag aus dem Ring in die Überlaufliste umhängen
+    std::atomic<int> m_overflow_moving{0};
+
+    // Vorrat an Überlaufknoten (so viele wie Zellen im Ring)
+    std::unique_ptr<OverflowNode[]> m_nodes;
+    std::atomic<size_t> m_node_hint{0};
+
+    std::atomic<uint64_t> m_frames_dropped{0};
+    std::atomic<uint64_t> m_events_overflowed{0};
+    std::atomic<uint64_t> m_overflow_nodes_allocated{0};
+    std::atomic<size_t> m_high_water{0};
+};
@@ -0,0 +1,99 @@
+#include "frame_timing.hpp"
+#include "plugin_log.hpp"
+#include "usage_stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+FrameTimingStats g_frame_timing;
+
+void FrameTiming::on_frame_start(bool timer_restart, uint64_t render_us, uint64_t simulation_us,
+                                 uint64_t paused_simulation_us) {
+    g_frame_timing.frames.fetch_add(1, std::memory_order_relaxed);
+
+    // Nach einem Neustart der Uhren (oder beim ersten Frame) gibt es keine Schritte
+    if (timer_restart || !m_have_previous || render_us < m_render_us || simulation_us < m_simulation_us ||
+        paused_simulation_us < m_paused_simulation_us) {
+        m_have_previous = true;
+        m_render_us = render_us;
+        m_simulation_us = simulation_us;
+        m_paused_simulation_us = paused_simulation_us;
+        m_paused = false;
+        g_frame_timing.paused.store(false, std::memory_order_relaxed);
+        start_window(render_us);
+        return;
+    }
+
+    const uint64_t interval = render_us - m_render_us;
+    const uint64_t simulation_step = simulation_us - m_simulation_us;
+    const uint64_t paused_step = paused_simulation_us - m_paused_simulation_us;
+    m_render_us = render_us;
+    m_simulation_us = simulation_us;
+    m_paused_simulation_us = paused_simulation_us;
+
+    ++m_window_frames;
+    m_interval_max_us = std::max(m_interval_max_us, interval);
+    if (simulation_step > 0) {
+        ++m_simulation_steps;
+        m_simulation_step_sum_us += simulation_step;
+    }
+    // Die Simulation läuft in festen Schritten und pendelt um die Renderzeit
+    const double offset = static_cast<double>(static_cast<int64_t>(simulation_us - render_us));
+    m_offset_sum += offset;
+    m_offset_sum_sq += offset * offset;
+
+    // Pause: die Simulationszeit läuft weiter, die pausierbare steht. Frames ohne
+    // Simulationsschritt sagen nichts aus.
+    if (simulation_step > 0 && paused_step == 0 && !m_paused) {
+        m_paused = true;
+        m_pause_start_us = render_us - interval;
+        g_frame_timing.paused.store(true, std::memory_order_relaxed);
+    } else if (paused_step > 0 && m_paused) {
+        m_paused = false;
+        const double seconds = static_cast<double>(render_us - m_pause_start_us) / 1e6;
+        g_frame_timing.paused.store(false, std::memory_order_relaxed);
+        g_frame_timing.pauses.fetch_add(1, std::memory_order_relaxed);
+        g_frame_timing.paused_s.store(g_frame_timing.paused_s.load(std::memory_order_relaxed) + seconds,
+                                      std::memory_order_relaxed);
+        g_frame_timing.last_pause_s.store(seconds, std::memory_order_relaxed);
+        PLOG_DEBUG(plugin, "Simulation resumed after %.1f s pause.", seconds);
+    }
+
+    if (render_us - m_window_start_us >= window_us) {
+        finish_window(render_us);
+    }
+}
+
+void FrameTiming::start_window(uint64_t render_us) {
+    m_window_start_us = render_us;
+    m_window_start_wall = std::chrono::steady_clock::now();
+    m_window_callback_ns = g_game_callback_ns.load(std::memory_order_relaxed);
+    m_window_frames = 0;
+    m_interval_max_us = 0;
+    m_simulation_steps = 0;
+    m_simulation_step_sum_us = 0;
+    m_offset_sum = 0.0;
+    m_offset_sum_sq = 0.0;
+}
+
+void FrameTiming::finish_window(uint64_t render_us) {
+    const double span_us = static_cast<double>(render_us - m_window_start_us);
+    const double frames = static_cast<double>(m_window_frames);
+    const double wall_ns = static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_window_start_wall).count());
+    const double callback_ns = static_cast<double>(g_game_callback_ns.load(std::memory_order_relaxed) - m_window_callback_ns);
+    const double mean_offset = m_offset_sum / frames;
+    const double variance = std::max(0.0, m_offset_sum_sq / frames - mean_offset * mean_offset);
+
+    g_frame_timing.fps.store(frames * 1e6 / span_us, std::memory_order_relaxed);
+    g_frame_timing.frame_interval_ms.store(span_us / frames / 1000.0, std::memory_order_relaxed);
+    g_frame_timing.frame_interval_max_ms.store(static_cast<double>(m_interval_max_us) / 1000.0, std::memory_order_relaxed);
+    g_frame_timing.simulation_step_ms.store(
+        m_simulation_steps > 0 ? static_cast<double>(m_simulation_step_sum_us) / m_simulation_steps / 1000.0 : 0.0,
+        std::memory_order_relaxed);
+    g_frame_timing.simulation_jitter_ms.store(std::sqrt(variance) / 1000.0, std::memory_order_relaxed);
+    g_frame_timing.plugin_ms_per_frame.store(callback_ns / frames / 1e6, std::memory_order_relaxed);
+    g_frame_timing.plugin_frame_ratio.store(wall_ns > 0 ? callback_ns / wall_ns : 0.0, std::memory_order_relaxed);
+
+    start_window(render_us);
+}
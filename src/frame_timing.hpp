@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Bildrate, Simulationsschritte und Pausen aus den Zeitstempeln von
+// SCS_TELEMETRY_EVENT_frame_start. Ausgewertet wird jeweils eine Sekunde
+// Renderzeit; das Ergebnis landet in g_frame_timing (relaxed atomics) und
+// geht von dort in /metrics und in {"type":"usage"}.
+struct FrameTimingStats {
+    // Letztes abgeschlossenes Fenster
+    std::atomic<double> fps{0.0};
+    std::atomic<double> frame_interval_ms{0.0};     // Mittel der Renderzeit-Schritte
+    std::atomic<double> frame_interval_max_ms{0.0};
+    std::atomic<double> simulation_step_ms{0.0};    // Mittel der Schritte, in denen simuliert wurde
+    std::atomic<double> simulation_jitter_ms{0.0};  // Standardabweichung von Simulations- minus Renderzeit
+    std::atomic<double> plugin_ms_per_frame{0.0};   // Zeit in unseren SDK-Callbacks pro Frame
+    std::atomic<double> plugin_frame_ratio{0.0};    // Anteil daran an der Wanduhr des Fensters
+
+    // Seit dem Start
+    std::atomic<uint64_t> frames{0};
+    std::atomic<bool> paused{false};
+    std::atomic<uint64_t> pauses{0};
+    std::atomic<double> paused_s{0.0};              // Summe abgeschlossener Pausen
+    std::atomic<double> last_pause_s{0.0};
+};
+
+extern FrameTimingStats g_frame_timing;
+
+// Nur vom Spiel-Thread benutzen
+class FrameTiming {
+public:
+    static constexpr uint64_t window_us = 1000000;
+
+    // Zeitstempel aus scs_telemetry_frame_start_t in Mikrosekunden
+    void on_frame_start(bool timer_restart, uint64_t render_us, uint64_t simulation_us, uint64_t paused_simulation_us);
+
+private:
+    void start_window(uint64_t render_us);
+    void finish_window(uint64_t render_us);
+
+    bool m_have_previous = false;
+    uint64_t m_render_us = 0;
+    uint64_t m_simulation_us = 0;
+    uint64_t m_paused_simulation_us = 0;
+
+    // Laufendes Fenster
+    uint64_t m_window_start_us = 0;
+    std::chrono::steady_clock::time_point m_window_start_wall;
+    uint64_t m_window_callback_ns = 0;
+    uint32_t m_window_frames = 0;
+    uint64_t m_interval_max_us = 0;
+    uint32_t m_simulation_steps = 0;
+    uint64_t m_simulation_step_sum_us = 0;
+    double m_offset_sum = 0.0;
+    double m_offset_sum_sq = 0.0;
+
+    uint64_t m_pause_start_us = 0;
+    bool m_paused = false;
+};
@@ -0,0 +1,160 @@
+#include "latency_stats.hpp"
+#include "plugin_log.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+// Werte unter 16 ns exakt, darüber 8 Unterteilungen pro Zweierpotenz bis 2^40 ns (ca. 18 min)
+constexpr int linear_buckets = 16;
+constexpr int sub_bits = 3;
+constexpr int max_exponent = 40;
+constexpr int bucket_count = linear_buckets + (max_exponent - 4 + 1) * (1 << sub_bits);
+constexpr size_t stage_count = static_cast<size_t>(LatencyStage::count);
+
+// Threads bekommen beim ersten Messwert einen eigenen Platz; wer keinen mehr bekommt,
+// teilt sich den letzten (die Zähler sind ohnehin atomar)
+constexpr int max_threads = 32;
+
+struct StageHistogram {
+    std::array<std::atomic<uint64_t>, bucket_count> buckets{};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum_ns{0};
+    std::atomic<uint64_t> max_ns{0};
+};
+
+struct ThreadHistograms {
+    std::array<StageHistogram, stage_count> stages;
+};
+
+// Statisch und null-initialisiert: Messen alloziert nie, auch nicht beim ersten Mal
+ThreadHistograms g_threads[max_threads];
+std::atomic<int> g_threads_used{0};
+thread_local int t_slot = -1;
+
+int highest_bit(uint64_t v) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(v);
+#endif
+}
+
+int bucket_of(uint64_t ns) {
+    if (ns < linear_buckets) return static_cast<int>(ns);
+    int exponent = highest_bit(ns);
+    if (exponent > max_exponent) return bucket_count - 1;
+    int sub = static_cast<int>((ns >> (exponent - sub_bits)) & ((1 << sub_bits) - 1));
+    return linear_buckets + (exponent - 4) * (1 << sub_bits) + sub;
+}
+
+// Mitte des Bereichs, den ein Eimer abdeckt
+double bucket_value(int bucket) {
+    if (bucket < linear_buckets) return bucket;
+    int exponent = (bucket - linear_buckets) / (1 << sub_bits) + 4;
+    int sub = (bucket - linear_buckets) % (1 << sub_bits);
+    double width = static_cast<double>(uint64_t(1) << (exponent - sub_bits));
+    return ((1 << sub_bits) + sub) * width + width / 2;
+}
+
+ThreadHistograms& own_histograms() {
+    if (t_slot < 0) {
+        int slot = g_threads_used.fetch_add(1, std::memory_order_relaxed);
+        t_slot = slot < max_threads ? slot : max_threads - 1;
+    }
+    return g_threads[t_slot];
+}
+
+const char* const stage_names[stage_count] = {
+    "channel_value", "config_event", "frame_delta", "encode", "queue_push", "client_send"};
+
+} // namespace
+
+void latency_record(LatencyStage stage, uint64_t ns) {
+    StageHistogram& h = own_histograms().stages[static_cast<size_t>(stage)];
+    h.buckets[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+    h.count.fetch_add(1, std::memory_order_relaxed);
+    h.sum_ns.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t max = h.max_ns.load(std::memory_order_relaxed);
+    while (ns > max && !h.max_ns.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+}
+
+const char* latency_stage_name(LatencyStage stage) {
+    return static_cast<size_t>(stage) < stage_count ? stage_names[static_cast<size_t>(stage)] : "?";
+}
+
+// Führt die Histogramme aller Threads zusammen. Ein Messwert, der gerade
+// geschrieben wird, fehlt vielleicht noch in einem Eimer; für Perzentile egal.
+LatencySummary latency_summary(LatencyStage stage) {
+    LatencySummary summary;
+    if (static_cast<size_t>(stage) >= stage_count) return summary;
+
+    std::array<uint64_t, bucket_count> merged{};
+    uint64_t sum_ns = 0;
+    uint64_t max_ns = 0;
+    int used = std::min(g_threads_used.load(std::memory_order_relaxed), max_threads);
+    for (int t = 0; t < used; ++t) {
+        const StageHistogram& h = g_threads[t].stages[static_cast<size_t>(stage)];
+        for (int b = 0; b < bucket_count; ++b) {
+            merged[b] += h.buckets[b].load(std::memory_order_relaxed);
+        }
+        sum_ns += h.sum_ns.load(std::memory_order_relaxed);
+        max_ns = std::max(max_ns, h.max_ns.load(std::memory_order_relaxed));
+    }
+    for (uint64_t n : merged) summary.count += n;
+    if (summary.count == 0) return summary;
+
+    auto percentile = [&](double p) {
+        uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(summary.count - 1));
+        uint64_t seen = 0;
+        for (int b = 0; b < bucket_count; ++b) {
+            seen += merged[b];
+            if (seen > rank) return std::min(bucket_value(b), static_cast<double>(max_ns)) / 1000.0;
+        }
+        return max_ns / 1000.0;
+    };
+    summary.mean_us = static_cast<double>(sum_ns) / static_cast<double>(summary.count) / 1000.0;
+    summary.p50_us = percentile(0.5);
+    summary.p90_us = percentile(0.9);
+    summary.p99_us = percentile(0.99);
+    summary.max_us = max_ns / 1000.0;
+    return summary;
+}
+
+nlohmann::json latency_stats_json() {
+    nlohmann::json stages = nlohmann::json::object();
+#if SCS_WS_LATENCY_STATS
+    for (size_t i = 0; i < stage_count; ++i) {
+        LatencySummary s = latency_summary(static_cast<LatencyStage>(i));
+        stages[stage_names[i]] = {{"count", s.count},
+                                  {"mean_us", s.mean_us},
+                                  {"p50_us", s.p50_us},
+                                  {"p90_us", s.p90_us},
+                                  {"p99_us", s.p99_us},
+                                  {"max_us", s.max_us}};
+    }
+#endif
+    return stages;
+}
+
+void latency_log_summary() {
+#if SCS_WS_LATENCY_STATS
+    for (size_t i = 0; i < stage_count; ++i) {
+        LatencySummary s = latency_summary(static_cast<LatencyStage>(i));
+        if (s.count == 0) continue;
+        PLOG_INFO(plugin, "Latency %-13s n=%llu mean %.2f us, p50 %.2f, p90 %.2f, p99 %.2f, max %.2f us",
+                  stage_names[i], static_cast<unsigned long long>(s.count),
+                  s.mean_us, s.p50_us, s.p90_us, s.p99_us, s.max_us);
+    }
+#endif
+}
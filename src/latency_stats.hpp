@@ -0,0 +1,83 @@
+#pragma once
+// Laufzeit-Histogramme für die Stationen der Pipeline (HDR-artig: 8 Unterteilungen
+// pro Zweierpotenz, also ca. 12 % Auflösung von Nanosekunden bis Minuten).
+// Jeder Thread zählt in sein eigenes Histogramm (nur relaxed atomics, keine Sperre),
+// beim Lesen werden alle zusammengeführt.
+//
+//   void TelemetryPlugin::on_channel_value(...) {
+//       LATENCY_SCOPE(channel_value);
+//
+// Wo nicht jeder Durchlauf zählen soll (z.B. nichts zu tun), benannt mit
+// LATENCY_TIMER(timer, client_send) und LATENCY_DISMISS(timer).
+//
+// Mit SCS_WS_LATENCY_STATS=0 verschwinden die Messpunkte vollständig.
+
+#include <chrono>
+#include <cstdint>
+
+#include <nlohmann/json.hpp>
+
+#ifndef SCS_WS_LATENCY_STATS
+#define SCS_WS_LATENCY_STATS 1
+#endif
+
+enum class LatencyStage : uint8_t {
+    channel_value,   // on_channel_value
+    config_event,    // Konfigurationsereignis übernehmen und veröffentlichen
+    frame_delta,     // on_frame_end: Änderungen gegenüber dem letzten Frame sammeln
+    encode,          // JSON/MessagePack kodieren
+    queue_push,      // an die Warteschlange zum Server-Thread übergeben
+    client_send,     // Server: wartende Nachrichten einer Verbindung an websocketpp übergeben
+    count
+};
+
+struct LatencySummary {
+    uint64_t count = 0;
+    double mean_us = 0;
+    double p50_us = 0;
+    double p90_us = 0;
+    double p99_us = 0;
+    double max_us = 0;
+};
+
+void latency_record(LatencyStage stage, uint64_t ns);
+LatencySummary latency_summary(LatencyStage stage);
+const char* latency_stage_name(LatencyStage stage);
+
+// {"channel_value": {"count":..,"mean_us":..,"p50_us":..,...}, ...}; leer, wenn abgeschaltet
+nlohmann::json latency_stats_json();
+
+// Eine Zeile pro Station ins Log (beim Beenden)
+void latency_log_summary();
+
+#if SCS_WS_LATENCY_STATS
+class LatencyTimer {
+public:
+    explicit LatencyTimer(LatencyStage stage) : m_stage(stage), m_start(std::chrono::steady_clock::now()) {}
+    ~LatencyTimer() {
+        if (m_stage == LatencyStage::count) return;
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+        latency_record(m_stage, static_cast<uint64_t>(ns));
+    }
+
+    LatencyTimer(const LatencyTimer&) = delete;
+    LatencyTimer& operator=(const LatencyTimer&) = delete;
+
+    // Durchlauf doch nicht aufzeichnen
+    void dismiss() { m_stage = LatencyStage::count; }
+
+private:
+    LatencyStage m_stage;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#define LATENCY_CONCAT_INNER(a, b) a##b
+#define LATENCY_CONCAT(a, b) LATENCY_CONCAT_INNER(a, b)
+#define LATENCY_SCOPE(stage) LatencyTimer LATENCY_CONCAT(latency_timer_, __LINE__)(LatencyStage::stage)
+#define LATENCY_TIMER(name, stage) LatencyTimer name(LatencyStage::stage)
+#define LATENCY_DISMISS(name) name.dismiss()
+#else
+#define LATENCY_SCOPE(stage) static_cast<void>(0)
+#define LATENCY_TIMER(name, stage) static_cast<void>(0)
+#define LATENCY_DISMISS(name) static_cast<void>(0)
+#endif
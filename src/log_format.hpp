@@ -0,0 +1,173 @@
+#pragma once
+// Aufbau der binären Logdatei (log_format=binary), gemeinsam benutzt vom Plugin
+// (Schreiber) und tools/log_decode.cpp (Leser). Little Endian, ohne Padding:
+//
+//   "SCSWLOG" version
+//   format:  type=1  u16 id  u8 level  u8 tag_len  tag  u16 fmt_len  fmt
+//   entry:   type=2  u16 id  i64 time_us (Unix-Zeit)  u16 args_len  args
+//
+// Ein format-Eintrag steht vor dem ersten entry, der ihn benutzt; nach einem
+// Neustart oder einer Rotation werden die IDs neu vergeben (spätere format-
+// Einträge ersetzen frühere). Argumente liegen roh und mit Typ-Byte vor:
+//   'i' i64, 'u' u64, 'f' f64, 'p' u64, 's' u16 Länge + Bytes
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace binlog {
+
+constexpr char magic[7] = {'S', 'C', 'S', 'W', 'L', 'O', 'G'};
+constexpr uint8_t version = 1;
+
+enum RecordType : uint8_t {
+    record_format = 1,
+    record_entry = 2,
+};
+
+enum ArgType : uint8_t {
+    arg_int = 'i',
+    arg_uint = 'u',
+    arg_double = 'f',
+    arg_pointer = 'p',
+    arg_string = 's',
+};
+
+// Eine printf-Umwandlung im Formatstring
+struct Spec {
+    size_t begin;     // Position des '%'
+    size_t end;       // hinter dem Umwandlungszeichen
+    char conversion;  // 'd', 's', ... ('%' für "%%")
+    char length;      // 0, 'H' (hh), 'h', 'l', 'L' (ll), 'z', 'j', 't', 'D' (long double)
+    int stars;        // Breite/Genauigkeit als '*'-Argument
+};
+
+// Sucht ab pos die nächste Umwandlung; false am Ende des Strings
+inline bool next_spec(const char* fmt, size_t& pos, Spec& spec) {
+    for (; fmt[pos]; ++pos) {
+        if (fmt[pos] != '%') continue;
+        spec.begin = pos++;
+        spec.length = 0;
+        spec.stars = 0;
+        while (fmt[pos] && (fmt[pos] == '-' || fmt[pos] == '+' || fmt[pos] == ' ' || fmt[pos] == '#' || fmt[pos] == '0')) ++pos;
+        for (; fmt[pos] && ((fmt[pos] >= '0' && fmt[pos] <= '9') || fmt[pos] == '.' || fmt[pos] == '*'); ++pos) {
+            if (fmt[pos] == '*') ++spec.stars;
+        }
+        switch (fmt[pos]) {
+        case 'h': spec.length = fmt[pos + 1] == 'h' ? 'H' : 'h'; pos += spec.length == 'H' ? 2 : 1; break;
+        case 'l': spec.length = fmt[pos + 1] == 'l' ? 'L' : 'l'; pos += spec.length == 'L' ? 2 : 1; break;
+        case 'z': case 'j': case 't': spec.length = fmt[pos++]; break;
+        case 'L': spec.length = 'D'; ++pos; break;
+        default: break;
+        }
+        if (!fmt[pos]) return false;
+        spec.conversion = fmt[pos++];
+        spec.end = pos;
+        return true;
+    }
+    return false;
+}
+
+inline bool is_signed_conversion(char c) { return c == 'd' || c == 'i'; }
+inline bool is_unsigned_conversion(char c) { return c == 'u' || c == 'x' || c == 'X' || c == 'o' || c == 'c'; }
+inline bool is_float_conversion(char c) {
+    return c == 'f' || c == 'F' || c == 'e' || c == 'E' || c == 'g' || c == 'G' || c == 'a' || c == 'A';
+}
+
+// Setzt Formatstring und gepackte Argumente wieder zu Text zusammen;
+// fehlende (abgeschnittene) Argumente erscheinen als "<?>"
+inline void format_args(const char* fmt, const char* args, size_t size, std::string& out) {
+    size_t at = 0;
+    auto take = [&](uint8_t type, void* value, size_t n) {
+        if (at + 1 + n > size || static_cast<uint8_t>(args[at]) != type) return false;
+        std::memcpy(value, args + at + 1, n);
+        at += 1 + n;
+        return true;
+    };
+
+    size_t pos = 0;
+    size_t last = 0;
+    Spec spec;
+    while (next_spec(fmt, pos, spec)) {
+        out.append(fmt + last, spec.begin - last);
+        last = spec.end;
+        if (spec.conversion == '%') {
+            out += '%';
+            continue;
+        }
+        if (spec.conversion == 'n') continue;
+
+        int64_t star[2] = {0, 0};
+        bool ok = true;
+        for (int i = 0; i < spec.stars && i < 2; ++i) ok = ok && take(arg_int, &star[i], sizeof(star[i]));
+
+        // Flags, Breite und Genauigkeit übernehmen, die Längenangabe passt zum gepackten Typ
+        size_t length_chars = spec.length == 0 ? 0 : (spec.length == 'H' || spec.length == 'L') ? 2 : 1;
+        std::string one(fmt + spec.begin, spec.end - 1 - spec.begin - length_chars);
+        char buf[512];
+        int n = -1;
+        auto print = [&](auto value) {
+            const int s0 = static_cast<int>(star[0]);
+            const int s1 = static_cast<int>(star[1]);
+            n = spec.stars == 0 ? std::snprintf(buf, sizeof(buf), one.c_str(), value)
+                : spec.stars == 1 ? std::snprintf(buf, sizeof(buf), one.c_str(), s0, value)
+                                  : std::snprintf(buf, sizeof(buf), one.c_str(), s0, s1, value);
+        };
+
+        if (ok && is_signed_conversion(spec.conversion)) {
+            int64_t v;
+            if ((ok = take(arg_int, &v, sizeof(v)))) {
+                one += "ll";
+                one += spec.conversion;
+                print(static_cast<long long>(v));
+            }
+        } else if (ok && is_unsigned_conversion(spec.conversion)) {
+            uint64_t v;
+            if ((ok = take(arg_uint, &v, sizeof(v)))) {
+                if (spec.conversion == 'c') {
+                    one += 'c';
+                    print(static_cast<int>(v));
+                } else {
+                    one += "ll";
+                    one += spec.conversion;
+                    print(static_cast<unsigned long long>(v));
+                }
+            }
+        } else if (ok && is_float_conversion(spec.conversion)) {
+            double v;
+            if ((ok = take(arg_double, &v, sizeof(v)))) {
+                one += spec.conversion;
+                print(v);
+            }
+        } else if (ok && spec.conversion == 'p') {
+            uint64_t v;
+            if ((ok = take(arg_pointer, &v, sizeof(v)))) {
+                one += 'p';
+                print(reinterpret_cast<void*>(static_cast<uintptr_t>(v)));
+            }
+        } else if (ok && spec.conversion == 's') {
+            uint16_t len;
+            if ((ok = take(arg_string, &len, sizeof(len)) && at + len <= size)) {
+                std::string text(args + at, len);
+                at += len;
+                one += 's';
+                print(text.c_str());
+            }
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            out += "<?>";
+            at = size; // Typen passen nicht mehr, Rest nicht raten
+        } else if (n > 0) {
+            out.append(buf, std::min<size_t>(static_cast<size_t>(n), sizeof(buf) - 1));
+        }
+    }
+    out.append(fmt + last);
+}
+
+} // namespace binlog
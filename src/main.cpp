@@ -3,6 +3,7 @@
 #include <eurotrucks2/scssdk_telemetry_eut2.h>
 #include <amtrucks/scssdk_telemetry_ats.h>
 #include <scssdk_telemetry_event.h>
+#include <algorithm>
 #include <iostream>
 #include <filesystem>
 
@@ -10,6 +11,9 @@
 #include "websocket_server.hpp"
 #include "scs_context.hpp"
 #include "plugin_log.hpp"
+#include "latency_stats.hpp"
+#include "usage_stats.hpp"
+#include "trace_recorder.hpp"
 
 static TelemetryPlugin plugin;
 const scs_telemetry_init_params_t* g_scs_params = nullptr;
@@ -52,41 +56,41 @@ SCSAPI_RESULT scs_telemetry_init(const scs_u32_t version, const scs_telemetry_in
         auto dll_dir = get_dll_directory();
         auto log_path = (dll_dir / "plugin_debug.log").string();
         plugin_log_init(log_path);
-        plugin_log_printf("scs_telemetry_init: Game: %s, Telemetry Version: %u.%u", p->common.game_id, SCS_GET_MAJOR_VERSION(version), SCS_GET_MINOR_VERSION(version));
+        PLOG_INFO(plugin, "scs_telemetry_init: Game: %s, Telemetry Version: %u.%u", p->common.game_id, SCS_GET_MAJOR_VERSION(version), SCS_GET_MINOR_VERSION(version));
     } catch (...) { /* Ohne Logging weiterarbeiten */ }
 
 
     // --- KORREKTE, SPIEL-SPEZIFISCHE VERSIONSPRÜFUNG ---
     const scs_u32_t game_data_version = p->common.game_version;
-    plugin_log_printf("[DIAGNOSE] Prüfe Spiel-ID: '%s', Spieldaten-Version: %u.%u", p->common.game_id, SCS_GET_MAJOR_VERSION(game_data_version), SCS_GET_MINOR_VERSION(game_data_version));
+    PLOG_DEBUG(plugin, "Prüfe Spiel-ID: '%s', Spieldaten-Version: %u.%u", p->common.game_id, SCS_GET_MAJOR_VERSION(game_data_version), SCS_GET_MINOR_VERSION(game_data_version));
 
     bool version_ok = false;
     if (p->common.game_id && strcmp(p->common.game_id, "eut2") == 0) {
-        plugin_log_printf("[DIAGNOSE] Spiel als 'eut2' erkannt.");
+        PLOG_DEBUG(plugin, "Spiel als 'eut2' erkannt.");
         // KORREKTUR: Vergleiche die game_data_version, nicht die API-Version
         if (game_data_version >= SCS_TELEMETRY_EUT2_GAME_VERSION_1_14) {
             version_ok = true;
         } else {
-            plugin_log_printf("[DIAGNOSE] ETS2 Version zu alt. Benötigt: >= 1.14");
+            PLOG_ERROR(plugin, "ETS2 Version zu alt. Benötigt: >= 1.14");
         }
     } 
     else if (p->common.game_id && strcmp(p->common.game_id, "ats") == 0) {
-        plugin_log_printf("[DIAGNOSE] Spiel als 'ats' erkannt.");
+        PLOG_DEBUG(plugin, "Spiel als 'ats' erkannt.");
         // KORREKTUR: Vergleiche die game_data_version, nicht die API-Version
         if (game_data_version >= SCS_TELEMETRY_ATS_GAME_VERSION_1_01) {
             version_ok = true;
         } else {
-            plugin_log_printf("[DIAGNOSE] ATS Version zu alt. Benötigt: >= 1.01");
+            PLOG_ERROR(plugin, "ATS Version zu alt. Benötigt: >= 1.01");
         }
     }
 
     if (!version_ok) {
-        plugin_log_printf("ERROR: Unsupported game data version for game '%s'.", p->common.game_id ? p->common.game_id : "NULL");
+        PLOG_ERROR(plugin, "Unsupported game data version for game '%s'.", p->common.game_id ? p->common.game_id : "NULL");
         return SCS_RESULT_unsupported;
     }
 	
 	g_game_id = p->common.game_id;
-	plugin_log_printf("Game ID stored globally: %s", g_game_id.c_str());
+	PLOG_DEBUG(plugin, "Game ID stored globally: %s", g_game_id.c_str());
     // --- ENDE DER VERSIONSPRÜFUNG ---
 
 
@@ -95,7 +99,17 @@ SCSAPI_RESULT scs_telemetry_init(const scs_u32_t version, const scs_telemetry_in
     // Konfiguration laden
     PluginConfig cfg = load_plugin_config();
     g_plugin_config = cfg;
-    plugin_log_printf("config: port=%d mode=%s ini=%s", cfg.port, cfg.mode.c_str(), cfg.ini_path_used.c_str());
+    plugin_log_configure(cfg.log_format == "binary", static_cast<uint64_t>(std::max(cfg.log_max_size_kb, 0)) * 1024,
+                         cfg.log_keep);
+    plugin_log_set_level(cfg.log_level);
+    for (const auto& tag_level : cfg.log_tag_levels) {
+        plugin_log_set_level(tag_level.second, tag_level.first);
+    }
+    if (!plugin_log_compiled(cfg.log_level)) {
+        PLOG_WARN(plugin, "log_level=%s, but this build only contains messages from level %s up.",
+                  plugin_log_level_name(cfg.log_level), plugin_log_level_name(static_cast<LogLevel>(plugin_log_compile_level)));
+    }
+    PLOG_INFO(plugin, "config: port=%d mode=%s ini=%s", cfg.port, cfg.mode.c_str(), cfg.ini_path_used.c_str());
 
     if (p->common.log) {
         std::string msg = "scs_ws_plugin: using INI at " + (cfg.ini_path_used.empty() ? "none" : cfg.ini_path_used) + ", port=" + std::to_string(cfg.port);
@@ -103,12 +117,12 @@ SCSAPI_RESULT scs_telemetry_init(const scs_u32_t version, const scs_telemetry_in
     }
 
     if (p->register_for_channel == nullptr || p->register_for_event == nullptr) {
-        plugin_log_printf("ERROR: register functions missing in params");
+        PLOG_ERROR(plugin, "register functions missing in params");
         return SCS_RESULT_generic_error;
     }
 
     // --- Kanal-Registrierung (dein bestehender Code bleibt hier, unverändert) ---
-    plugin_log_printf("Registering channels...");
+    PLOG_DEBUG(plugin, "Registering channels...");
     const char* float_channels[] = {
         "truck.speed", "truck.engine.rpm", "truck.cruise_control", "truck.brake.air.pressure", "truck.brake.temperature", "truck.fuel.amount",
 		"truck.fuel.consumption.average", "truck.fuel.range", "truck.adblue", "truck.wear.engine", "truck.wear.transmission", "truck.wear.cabin",
@@ -118,9 +132,9 @@ SCSAPI_RESULT scs_telemetry_init(const scs_u32_t version, const scs_telemetry_in
     };
     for (const auto& channel : float_channels) {
         if (p->register_for_channel(channel, SCS_U32_NIL, SCS_VALUE_TYPE_float, 0, TelemetryPlugin::scs_on_channel_value, &plugin) == SCS_RESULT_ok) {
-            plugin_log_printf("Registered float channel: %s", channel);
+            PLOG_DEBUG(plugin, "Registered float channel: %s", channel);
         } else {
-            plugin_log_printf("Failed to register float channel: %s", channel);
+            PLOG_WARN(plugin, "Failed to register float channel: %s", channel);
         }
     }
 
@@ -133,9 +147,9 @@ SCSAPI_RESULT scs_telemetry_init(const scs_u32_t version, const scs_telemetry_in
     };
     for (const auto& channel : bool_channels) {
         if (p->register_for_channel(channel, SCS_U32_NIL, SCS_VALUE_TYPE_bool, 0, TelemetryPlugin::scs_on_channel_value, &plugin) == SCS_RESULT_ok) {
-            plugin_log_printf("Registered bool channel: %s", channel);
+            PLOG_DEBUG(plugin, "Registered bool channel: %s", channel);
         } else {
-            plugin_log_printf("Failed to register bool channel: %s", channel);
+            PLOG_WARN(plugin, "Failed to register bool channel: %s", channel);
         }
     }
 	
@@ -147,9 +161,9 @@ SCSAPI_RESULT scs_telemetry_init(const scs_u32_t version, const scs_telemetry_in
 	
 	for (const auto& channel : int_channels) {
 		if(p->register_for_channel(channel, SCS_U32_NIL, SCS_VALUE_TYPE_s32, 0, TelemetryPlugin::scs_on_channel_value, &plugin) == SCS_RESULT_ok) {
-			plugin_log_printf("Registed int channel: %s", channel);
+			PLOG_DEBUG(plugin, "Registered int channel: %s", channel);
 		}else {
-			plugin_log_printf("Failed to register int channel: %s", channel);
+			PLOG_WARN(plugin, "Failed to register int channel: %s", channel);
 		}
 	}
 
@@ -161,42 +175,49 @@ SCSAPI_RESULT scs_telemetry_init(const scs_u32_t version, const scs_telemetry_in
     };
     for (const auto& channel : string_channels) {
         if (p->register_for_channel(channel, SCS_U32_NIL, SCS_VALUE_TYPE_string, 0, TelemetryPlugin::scs_on_channel_value, &plugin) == SCS_RESULT_ok) {
-            plugin_log_printf("Registered string channel: %s", channel);
+            PLOG_DEBUG(plugin, "Registered string channel: %s", channel);
         } else {
-            plugin_log_printf("Failed to register string channel: %s", channel);
+            PLOG_WARN(plugin, "Failed to register string channel: %s", channel);
         }
     }
 
 
     // --- Event-Registrierung (mit Fehlerprüfung) ---
-    plugin_log_printf("Registering for events...");
+    PLOG_DEBUG(plugin, "Registering for events...");
 
+    if (p->register_for_event(SCS_TELEMETRY_EVENT_frame_start, TelemetryPlugin::scs_on_event, &plugin) != SCS_RESULT_ok) {
+        PLOG_ERROR(plugin, "Failed to register for SCS_TELEMETRY_EVENT_frame_start");
+    }
     if (p->register_for_event(SCS_TELEMETRY_EVENT_frame_end, TelemetryPlugin::scs_on_event, &plugin) != SCS_RESULT_ok) {
-        plugin_log_printf("ERROR: Failed to register for SCS_TELEMETRY_EVENT_frame_end");
+        PLOG_ERROR(plugin, "Failed to register for SCS_TELEMETRY_EVENT_frame_end");
     }
     if (p->register_for_event(SCS_TELEMETRY_EVENT_paused, TelemetryPlugin::scs_on_event, &plugin) != SCS_RESULT_ok) {
-        plugin_log_printf("ERROR: Failed to register for SCS_TELEMETRY_EVENT_paused");
+        PLOG_ERROR(plugin, "Failed to register for SCS_TELEMETRY_EVENT_paused");
     }
     if (p->register_for_event(SCS_TELEMETRY_EVENT_started, TelemetryPlugin::scs_on_event, &plugin) != SCS_RESULT_ok) {
-        plugin_log_printf("ERROR: Failed to register for SCS_TELEMETRY_EVENT_started");
+        PLOG_ERROR(plugin, "Failed to register for SCS_TELEMETRY_EVENT_started");
     }
     if (p->register_for_event(SCS_TELEMETRY_EVENT_configuration, TelemetryPlugin::scs_on_event, &plugin) != SCS_RESULT_ok) {
-        plugin_log_printf("ERROR: Failed to register for SCS_TELEMETRY_EVENT_configuration");
+        PLOG_ERROR(plugin, "Failed to register for SCS_TELEMETRY_EVENT_configuration");
     }
     if (p->register_for_event(SCS_TELEMETRY_EVENT_gameplay, TelemetryPlugin::scs_on_event, &plugin) != SCS_RESULT_ok) {
-        plugin_log_printf("ERROR: Failed to register for SCS_TELEMETRY_EVENT_gameplay");
+        PLOG_ERROR(plugin, "Failed to register for SCS_TELEMETRY_EVENT_gameplay");
     }
 
     plugin.start();
 
-    bool ws_started = websocket_server.start(static_cast<unsigned short>(cfg.port));
+    bool ws_started = websocket_server.start(cfg);
     if (ws_started) {
-        plugin_log_printf("websocket started on port %d", cfg.port);
+        PLOG_INFO(plugin, "websocket started on port %d", cfg.port);
     } else {
-        plugin_log_printf("websocket failed to start on port %d", cfg.port);
+        PLOG_ERROR(plugin, "websocket failed to start on port %d", cfg.port);
+    }
+    // Geschrieben wird der Trace vom Server-Thread
+    if (ws_started && cfg.trace_at_start_ms > 0) {
+        trace_start(static_cast<uint32_t>(cfg.trace_at_start_ms), cfg.trace_file);
     }
 
-    plugin_log_printf("scs_telemetry_init: plugin initialized successfully.");
+    PLOG_INFO(plugin, "scs_telemetry_init: plugin initialized successfully.");
     if (p->common.log) {
         p->common.log(SCS_LOG_TYPE_message, "scs_telemetry_init: plugin initialized");
     }
@@ -205,11 +226,14 @@ SCSAPI_RESULT scs_telemetry_init(const scs_u32_t version, const scs_telemetry_in
 
 SCSAPI_VOID scs_telemetry_shutdown(void)
 {
-    plugin_log_printf("scs_telemetry_shutdown: begin");
+    PLOG_INFO(plugin, "scs_telemetry_shutdown: begin");
     websocket_server.stop();
     plugin.stop();
+    trace_shutdown(); // danach zeichnet kein Thread mehr auf
     g_scs_params = nullptr;
-    plugin_log_printf("scs_telemetry_shutdown: stopping and closing log");
+    latency_log_summary();
+    usage_log_summary();
+    PLOG_INFO(plugin, "scs_telemetry_shutdown: stopping and closing log");
     plugin_log_close();
     std::cout << "[SCS Plugin] Telemetry shut down." << std::endl;
 }
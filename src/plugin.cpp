@@ -3,7 +3,12 @@
 #include "scs_context.hpp"
 #include "websocket_server.hpp"
 #include "plugin_log.hpp"
+#include "latency_stats.hpp"
+#include "plugin_metrics.hpp"
+#include "trace_recorder.hpp"
+#include "usage_stats.hpp"
 #include <nlohmann/json.hpp>
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <cmath>
@@ -33,44 +38,78 @@ static nlohmann::json scs_value_to_json(const std::string& channel_name, const s
 // on_channel_value (unverändert)
 void TelemetryPlugin::on_channel_value(const char* name, const scs_u32_t index, const scs_value_t* value) {
     if (!name) return;
+    GameCallbackTimer callback_timer;
+    LATENCY_SCOPE(channel_value);
+    if (trace_active()) {
+        if (channel_burst_start == 0) channel_burst_start = trace_now_ns();
+        ++channel_burst_count;
+    }
     try {
-        std::string channel_name = name;
+        // Puffer wiederverwenden, damit der Aufruf im eingeschwungenen Zustand nicht alloziert
+        std::string& channel_name = channel_name_buffer;
+        channel_name.assign(name);
         if (index != SCS_U32_NIL) {
-            channel_name += "[" + std::to_string(index) + "]";
+            channel_name += '[';
+            channel_name += std::to_string(index);
+            channel_name += ']';
         }
         nlohmann::json val = scs_value_to_json(channel_name, value);
         std::lock_guard<std::mutex> lock(state_mutex);
-        current_telemetry_state[channel_name] = val;
+        auto it = current_telemetry_state.find(channel_name);
+        if (it != current_telemetry_state.end()) {
+            it->second = std::move(val);
+        } else {
+            current_telemetry_state.emplace(channel_name, std::move(val));
+        }
     } catch (const std::exception& e) {
-        plugin_log_printf("[PLUGIN] Exception in on_channel_value: %s", e.what());
+        PLOG_ERROR(plugin, "Exception in on_channel_value: %s", e.what());
     }
 }
 
 // on_event (unverändert, die wichtige Logik hier drin ist korrekt)
 void TelemetryPlugin::on_event(const scs_event_t event, const void* event_info) {
+    GameCallbackTimer callback_timer;
     try {
-        plugin_log_printf("[DIAGNOSE] Event empfangen, Typ: %d", event);
+        PLOG_TRACE(plugin, "Event empfangen, Typ: %d", event);
 
         if (event == SCS_TELEMETRY_EVENT_configuration && event_info) {
+            TRACE_SCOPE("config_event");
             const auto* config_event = static_cast<const scs_telemetry_configuration_t*>(event_info);
             if (config_event->id) {
-                plugin_log_printf("[DIAGNOSE] Configuration Event ID: %s", config_event->id);
+                PLOG_DEBUG(plugin, "Configuration Event ID: %s", config_event->id);
             }
             std::string config_id = config_event->id;
-            std::lock_guard<std::mutex> lock(state_mutex);
-            for (const scs_named_value_t* attr = config_event->attributes; attr && attr->name; ++attr) {
-                std::string key = config_id + "." + attr->name;
-                current_telemetry_state[key] = scs_value_to_json(key, &attr->value);
+            nlohmann::json attributes_json = nlohmann::json::object();
+            {
+                LATENCY_SCOPE(config_event);
+                std::lock_guard<std::mutex> lock(state_mutex);
+                for (const scs_named_value_t* attr = config_event->attributes; attr && attr->name; ++attr) {
+                    std::string key = config_id + "." + attr->name;
+                    nlohmann::json value = scs_value_to_json(key, &attr->value);
+                    current_telemetry_state[key] = value;
+                    std::string attr_name = attr->name;
+                    if (attr->index != SCS_U32_NIL) {
+                        attr_name += "[" + std::to_string(attr->index) + "]";
+                    }
+                    attributes_json[attr_name] = std::move(value);
+                }
             }
+
+            nlohmann::json config_json;
+            config_json["type"] = "config";
+            config_json["id"] = config_id;
+            config_json["attributes"] = std::move(attributes_json);
+            publish(MessageKind::config, config_json);
             return;
         }
 
         if (event == SCS_TELEMETRY_EVENT_gameplay && event_info) {
+            TRACE_SCOPE("gameplay_event");
             const auto* gameplay_event = static_cast<const scs_telemetry_gameplay_event_t*>(event_info);
             if (!gameplay_event || !gameplay_event->id) {
                 return;
             }
-            plugin_log_printf("[DIAGNOSE] Gameplay Event ID: %s", gameplay_event->id);
+            PLOG_DEBUG(plugin, "Gameplay Event ID: %s", gameplay_event->id);
             
             nlohmann::json event_json;
             event_json["type"] = "gameplay";
@@ -82,7 +121,7 @@ void TelemetryPlugin::on_event(const scs_event_t event, const void* event_info)
             if (!attributes_json.empty()) {
                 event_json["attributes"] = attributes_json;
             }
-            websocket_server.queue_broadcast(event_json.dump());
+            publish(MessageKind::gameplay, event_json);
 
             if (strcmp(gameplay_event->id, "job.delivered") == 0 || strcmp(gameplay_event->id, "job.cancelled") == 0) {
                 clear_job_data();
@@ -90,19 +129,44 @@ void TelemetryPlugin::on_event(const scs_event_t event, const void* event_info)
             return;
         }
 
+        if (event == SCS_TELEMETRY_EVENT_frame_start && event_info) {
+            const auto* frame_start = static_cast<const scs_telemetry_frame_start_t*>(event_info);
+            frame_timing.on_frame_start((frame_start->flags & SCS_TELEMETRY_FRAME_START_FLAG_timer_restart) != 0,
+                                        frame_start->render_time, frame_start->simulation_time,
+                                        frame_start->paused_simulation_time);
+            return;
+        }
+
         if (event == SCS_TELEMETRY_EVENT_frame_end) {
+            // Das Budget umfasst den ganzen Callback, nicht nur on_frame_end()
+            auto start = std::chrono::steady_clock::now();
+            if (channel_burst_start != 0) {
+                trace_span("channel_values", channel_burst_start, trace_now_ns(), channel_burst_count);
+                channel_burst_start = 0;
+                channel_burst_count = 0;
+            }
+            g_metrics.frames_ingested.fetch_add(1, std::memory_order_relaxed);
+            // Über dem Budget nur jeden n-ten Frame veröffentlichen, außer der Server wartet auf einen Snapshot
+            if (websocket_server.snapshot_generation() == last_snapshot_generation && !frame_budget.should_publish()) {
+                return;
+            }
             on_frame_end();
+            auto end = std::chrono::steady_clock::now();
+            frame_budget.record(
+                static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()), end);
         }
 
     } catch (const std::exception& e) {
-        plugin_log_printf("[PLUGIN] Exception in on_event: %s", e.what());
+        PLOG_ERROR(plugin, "Exception in on_event: %s", e.what());
     }
 }
 
 // on_frame_end (mit Korrektur)
 void TelemetryPlugin::on_frame_end() {
+    TRACE_SCOPE("frame_end");
     try {
         std::lock_guard<std::mutex> lock(state_mutex);
+        frame_arena.release(); // Hilfsstrukturen des vorigen Frames verwerfen
 
         if (g_plugin_config.mode == "devenv") {
             auto now = std::chrono::steady_clock::now();
@@ -110,48 +174,113 @@ void TelemetryPlugin::on_frame_end() {
                 return;
             }
             last_devenv_send_time = now;
-            nlohmann::json frame_data = current_telemetry_state;
-            frame_data["timestamp"] = std::time(nullptr);
-            frame_data["game"] = g_game_id;
-            websocket_server.queue_broadcast(frame_data.dump());
+            // Ein Voll-Frame bedient auch eine Snapshot-Anforderung des Servers
+            last_snapshot_generation = websocket_server.snapshot_generation();
+            publish_state(MessageKind::frame, true);
             return;
         }
 
         if (g_plugin_config.mode == "delta") {
-            nlohmann::json delta_data;
-            // ================== HIER IST DIE KORREKTUR ==================
-            // Der Iterator eines JSON-Objekts wird wie ein std::map-Iterator behandelt.
-            // Zugriff erfolgt über it->first für den Schlüssel und it->second für den Wert.
-            for (auto it = current_telemetry_state.cbegin(); it != current_telemetry_state.cend(); ++it) {
-                if (last_sent_telemetry_state.find(it->first) == last_sent_telemetry_state.end() || last_sent_telemetry_state[it->first] != it->second) {
-                    delta_data[it->first] = it->second;
+            // Geänderte Einträge nur referenzieren; der zuletzt gesendete Zustand wird
+            // dabei direkt nachgezogen statt am Ende komplett kopiert
+            std::pmr::vector<const FrameEncoder::Field*> changed(&frame_arena);
+            {
+                LATENCY_SCOPE(frame_delta);
+                changed.reserve(current_telemetry_state.size());
+                for (const auto& entry : current_telemetry_state) {
+                    auto sent = last_sent_telemetry_state.find(entry.first);
+                    if (sent == last_sent_telemetry_state.end()) {
+                        last_sent_telemetry_state.emplace(entry.first, entry.second);
+                        changed.push_back(&entry);
+                    } else if (sent->second != entry.second) {
+                        sent->second = entry.second;
+                        changed.push_back(&entry);
+                    }
                 }
             }
-            // ==========================================================
 
-            if (!delta_data.empty()) {
-                delta_data["timestamp"] = std::time(nullptr);
-                delta_data["game"] = g_game_id;
-                websocket_server.queue_broadcast(delta_data.dump());
+            if (!changed.empty()) {
+                publish_fields(MessageKind::frame, changed.data(), changed.size(), false);
+            }
+
+            // Snapshot-Abnehmer (Shared Memory, HTTP) brauchen zusätzlich den vollen Zustand,
+            // höchstens einmal pro Frame und nur wenn sich etwas geändert hat oder der Server danach fragt
+            uint64_t generation = websocket_server.snapshot_generation();
+            bool snapshot_requested = generation != last_snapshot_generation;
+            bool snapshot_consumers = g_plugin_config.shm_enabled || websocket_server.snapshot_wanted();
+            if (snapshot_consumers && (!changed.empty() || snapshot_requested)) {
+                last_snapshot_generation = generation;
+                publish_state(MessageKind::snapshot, true);
             }
-            last_sent_telemetry_state = current_telemetry_state;
             return;
         }
 
         // FULL-Modus (Fallback)
-        nlohmann::json frame_data = current_telemetry_state;
-        frame_data["timestamp"] = std::time(nullptr);
-        frame_data["game"] = g_game_id;
-        websocket_server.queue_broadcast(frame_data.dump());
+        last_snapshot_generation = websocket_server.snapshot_generation();
+        publish_state(MessageKind::frame, true);
 
     } catch (const std::exception& e) {
-        plugin_log_printf("[PLUGIN] Exception in on_frame_end: %s", e.what());
+        PLOG_ERROR(plugin, "Exception in on_frame_end: %s", e.what());
+    }
+}
+
+// Wird MessagePack von irgendeinem Ausgang gebraucht? Der Binär-Stream verlässt
+// sich darauf, dass dann jedes Frame beide Formate hat (siehe StreamSink::send).
+static bool msgpack_wanted(const PluginConfig& cfg) {
+    return websocket_server.msgpack_wanted() ||
+           (cfg.udp_enabled && cfg.udp_format == "msgpack") ||
+           (cfg.shm_enabled && cfg.shm_format == "msgpack") ||
+           ((cfg.stream_tcp_port > 0 || !cfg.stream_unix_path.empty()) && cfg.stream_format == "binary");
+}
+
+// publish: einmal kodieren, überall teilen
+void TelemetryPlugin::publish(MessageKind kind, const nlohmann::json& message, bool full_state) {
+    std::shared_ptr<EncodedFrame> frame = frame_pool.acquire();
+    frame->seq = ++next_seq;
+    frame->kind = kind;
+    frame->full_state = full_state;
+    {
+        LATENCY_SCOPE(encode);
+        TRACE_SCOPE("encode");
+        encoder.encode(message, msgpack_wanted(g_plugin_config), *frame);
+    }
+    frame_pool.note_size(frame->json.size());
+    g_metrics.messages_encoded.fetch_add(1, std::memory_order_relaxed);
+    LATENCY_SCOPE(queue_push);
+    TRACE_SCOPE("queue_push");
+    websocket_server.queue_broadcast(std::move(frame));
+}
+
+void TelemetryPlugin::publish_fields(MessageKind kind, const FrameEncoder::Field* const* fields, size_t count, bool full_state) {
+    std::shared_ptr<EncodedFrame> frame = frame_pool.acquire();
+    frame->seq = ++next_seq;
+    frame->kind = kind;
+    frame->full_state = full_state;
+    {
+        LATENCY_SCOPE(encode);
+        TRACE_SCOPE("encode");
+        encoder.encode_fields(fields, count, static_cast<int64_t>(std::time(nullptr)), g_game_id, msgpack_wanted(g_plugin_config), *frame);
+    }
+    frame_pool.note_size(frame->json.size());
+    g_metrics.messages_encoded.fetch_add(1, std::memory_order_relaxed);
+    LATENCY_SCOPE(queue_push);
+    TRACE_SCOPE("queue_push");
+    websocket_server.queue_broadcast(std::move(frame));
+}
+
+// Vollständiger Zustand (state_mutex muss gehalten werden)
+void TelemetryPlugin::publish_state(MessageKind kind, bool full_state) {
+    std::pmr::vector<const FrameEncoder::Field*> fields(&frame_arena);
+    fields.reserve(current_telemetry_state.size());
+    for (const auto& entry : current_telemetry_state) {
+        fields.push_back(&entry);
     }
+    publish_fields(kind, fields.data(), fields.size(), full_state);
 }
 
 // clear_job_data (mit Korrektur)
 void TelemetryPlugin::clear_job_data() {
-    plugin_log_printf("[PLUGIN] clear_job_data: Removing internal job and cargo data");
+    PLOG_DEBUG(plugin, "clear_job_data: Removing internal job and cargo data");
     
     std::lock_guard<std::mutex> lock(state_mutex);
     std::vector<std::string> keys_to_remove;
@@ -167,20 +296,23 @@ void TelemetryPlugin::clear_job_data() {
 
     for (const auto& key : keys_to_remove) {
         current_telemetry_state.erase(key);
+        last_sent_telemetry_state.erase(key); // damit ein neuer Auftrag wieder vollständig gesendet wird
     }
     
-    plugin_log_printf("[PLUGIN] %zu job-bezogene Schlüssel aus dem internen Zustand entfernt.", keys_to_remove.size());
+    PLOG_DEBUG(plugin, "%zu job-bezogene Schlüssel aus dem internen Zustand entfernt.", keys_to_remove.size());
 }
 
 // --- Start/Stop und statische Wrapper (unverändert) ---
 void TelemetryPlugin::start() {
     running = true;
     last_devenv_send_time = std::chrono::steady_clock::now();
-    plugin_log_printf("TelemetryPlugin started with multi-mode support");
+    trace_name_thread("game");
+    frame_budget.configure(static_cast<uint32_t>(std::max(g_plugin_config.frame_budget_us, 0)), std::chrono::steady_clock::now());
+    PLOG_INFO(plugin, "TelemetryPlugin started with multi-mode support");
 }
 void TelemetryPlugin::stop() {
     running = false;
-    plugin_log_printf("TelemetryPlugin stopped");
+    PLOG_INFO(plugin, "TelemetryPlugin stopped");
 }
 void TelemetryPlugin::scs_on_channel_value(const scs_string_t name, const scs_u32_t index, const scs_value_t* value, const scs_context_t context) {
     TelemetryPlugin* self = static_cast<TelemetryPlugin*>(context);
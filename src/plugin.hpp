@@ -6,6 +6,16 @@
 #include <map>
 #include <mutex>
 #include <chrono>
+#include <memory_resource>
+#include <cstddef>
+#include <cstdint>
+
+#include "counting_allocator.hpp"
+#include "encoded_frame.hpp"
+#include "frame_budget.hpp"
+#include "frame_encoder.hpp"
+#include "frame_pool.hpp"
+#include "frame_timing.hpp"
 
 class TelemetryPlugin {
 public:
@@ -25,12 +35,40 @@ public:
 	void clear_job_data();
 
 private:
+    // Kodiert eine Nachricht genau einmal und reicht sie an alle Ausgänge weiter
+    void publish(MessageKind kind, const nlohmann::json& message, bool full_state = false);
+    // Dasselbe für Felder des Telemetrie-Zustands (ohne Kopie in ein JSON-Objekt)
+    void publish_fields(MessageKind kind, const FrameEncoder::Field* const* fields, size_t count, bool full_state);
+    void publish_state(MessageKind kind, bool full_state);
+
     bool running = false;
+    uint64_t next_seq = 0;
+    uint64_t last_snapshot_generation = 0; // zuletzt bediente Snapshot-Anforderung des Servers
 
     // Thread-sichere Maps zum Speichern des Telemetrie-Zustands
     std::mutex state_mutex;
-    std::map<std::string, nlohmann::json> current_telemetry_state;
-    std::map<std::string, nlohmann::json> last_sent_telemetry_state; // Für den Delta-Modus
+    // (Knoten zählen unter MemoryUse::state; FrameEncoder::Field ist derselbe value_type)
+    using TelemetryMap = std::map<std::string, nlohmann::json, std::less<std::string>,
+                                  CountingAllocator<std::pair<const std::string, nlohmann::json>, MemoryUse::state>>;
+    TelemetryMap current_telemetry_state;
+    TelemetryMap last_sent_telemetry_state; // Für den Delta-Modus
+
+    // Kodierung: wiederverwendete Frames und Puffer, pro Frame eine Arena für Hilfsstrukturen
+    FramePool frame_pool;
+    FrameEncoder encoder;
+    alignas(std::max_align_t) std::byte frame_arena_buffer[64 * 1024];
+    std::pmr::monotonic_buffer_resource frame_arena{frame_arena_buffer, sizeof(frame_arena_buffer)};
+    std::string channel_name_buffer; // nur Spiel-Thread
+
+    // Zeit pro frame_end gegen frame_budget_us, lässt bei Bedarf Frames aus
+    FrameBudget frame_budget;
+
+    // Bildrate, Simulationsschritte und Pausen aus frame_start
+    FrameTiming frame_timing;
+
+    // Trace: Kanal-Callbacks seit dem letzten frame_end als eine Spanne
+    int64_t channel_burst_start = 0;
+    uint64_t channel_burst_count = 0;
 
     // Zeitsteuerung für den Devenv-Modus
     std::chrono::steady_clock::time_point last_devenv_send_time;
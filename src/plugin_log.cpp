@@ -1,57 +1,518 @@
 #include "plugin_log.hpp"
-#include <fstream>
-#include <mutex>
+#include "log_format.hpp"
+#include "usage_stats.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
 #include <cstdarg>
 #include <cstdio>
+#include <cctype>
+#include <cstring>
 #include <chrono>
-#include <iomanip>
-#include <sstream>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// Die Aufrufer (auch der Spiel-Thread) formatieren nur in einen sperrfreien Ring
+// fester Einträge (Vyukov, wie FrameQueue). Geschrieben und geflusht wird
+// gesammelt von einem eigenen Thread alle 100 ms (bei vielen Zeilen schon nach
+// einem halben Ring), bei plugin_log_flush() und beim Schließen. Ist der Ring
+// voll, wird die Zeile verworfen und gezählt.
+//
+// Im Binärformat (log_format=binary) formatieren die Aufrufer gar nicht mehr:
+// sie legen nur den Formatstring-Zeiger und die rohen Argumente ab, der
+// Schreib-Thread vergibt pro Aufrufstelle eine ID (siehe log_format.hpp).
+namespace {
+
+constexpr size_t log_capacity = 2048;     // Zweierpotenz
+constexpr size_t log_text_size = 496;     // längere Zeilen/Argumente werden abgeschnitten
+constexpr auto log_interval = std::chrono::milliseconds(100);
+
+struct LogRecord {
+    std::atomic<size_t> sequence;
+    int64_t time_us;                       // system_clock
+    const char* fmt;                       // nur binär: Formatstring der Aufrufstelle
+    uint32_t length;                       // Text bzw. gepackte Argumente
+    LogLevel level;
+    LogTag tag;
+    bool binary;
+    char text[log_text_size];
+};
+
+struct LogRing {
+    LogRing() {
+        for (size_t i = 0; i < log_capacity; ++i) records[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    LogRecord records[log_capacity];
+    alignas(64) std::atomic<size_t> enqueue_pos{0};
+    alignas(64) std::atomic<size_t> dequeue_pos{0}; // geschrieben nur unter g_write_mutex
+};
+
+LogRing g_ring;
+std::atomic<bool> g_open{false};
+std::atomic<bool> g_binary{false};
+std::atomic<uint64_t> g_dropped{0};
+uint64_t g_dropped_reported = 0;
+
+// Schreibseite: Datei, Ring-Leser und Schreib-Thread (alles unter g_write_mutex)
+std::mutex g_write_mutex;
+std::ofstream g_log;
+std::string g_text_path;                  // wie an plugin_log_init übergeben
+bool g_file_binary = false;
+uint64_t g_file_bytes = 0;
+uint64_t g_max_bytes = 4 * 1024 * 1024;   // 0 = nie rotieren
+int g_keep = 3;
+
+struct FormatKey {
+    const char* fmt;
+    LogLevel level;
+    LogTag tag;
+    bool operator==(const FormatKey& o) const { return fmt == o.fmt && level == o.level && tag == o.tag; }
+};
+struct FormatKeyHash {
+    size_t operator()(const FormatKey& k) const {
+        return std::hash<const void*>()(k.fmt) ^ (static_cast<size_t>(k.level) << 3) ^ (static_cast<size_t>(k.tag) << 7);
+    }
+};
+std::unordered_map<FormatKey, uint16_t, FormatKeyHash> g_format_ids; // gilt für die aktuelle Datei
+
+std::thread g_writer;
+std::mutex g_wake_mutex;
+std::condition_variable g_wake;
+bool g_stop = false;
+
+const char* const tag_names[] = {"PLUGIN", "Config", "WS", "HTTP", "SSE", "Stream", "UDP", "SHM", "Journal", "Log"};
+static_assert(sizeof(tag_names) / sizeof(tag_names[0]) == static_cast<size_t>(LogTag::count), "tag_names");
+
+// Für die Datei auf gleiche Breite gebracht
+const char* const level_columns[] = {"TRACE ", "DEBUG ", "INFO  ", "WARN  ", "ERROR ", "      "};
+
+bool equals_ignore_case(const std::string& a, const char* b) {
+    size_t n = std::strlen(b);
+    if (a.size() != n) return false;
+    for (size_t i = 0; i < n; ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) return false;
+    }
+    return true;
+}
+
+// localtime nur einmal pro Sekunde
+int64_t g_stamp_second = -1;
+char g_stamp[32];
+
+int64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Legt die Argumente passend zu den Umwandlungen im Formatstring ab
+uint32_t pack_args(char* out, size_t capacity, const char* fmt, va_list ap) {
+    size_t used = 0;
+    auto put = [&](uint8_t type, const void* value, size_t n) {
+        if (used + 1 + n > capacity) return false;
+        out[used] = static_cast<char>(type);
+        std::memcpy(out + used + 1, value, n);
+        used += 1 + n;
+        return true;
+    };
+
+    size_t pos = 0;
+    binlog::Spec spec;
+    bool room = true;
+    while (room && binlog::next_spec(fmt, pos, spec)) {
+        const char c = spec.conversion;
+        if (c == '%') continue;
+        for (int i = 0; i < spec.stars; ++i) {
+            int64_t v = va_arg(ap, int);
+            room = room && put(binlog::arg_int, &v, sizeof(v));
+        }
+        if (binlog::is_signed_conversion(c)) {
+            int64_t v;
+            switch (spec.length) {
+            case 'l': v = va_arg(ap, long); break;
+            case 'L': v = va_arg(ap, long long); break;
+            case 'z': v = static_cast<int64_t>(va_arg(ap, size_t)); break;
+            case 'j': v = va_arg(ap, intmax_t); break;
+            case 't': v = va_arg(ap, ptrdiff_t); break;
+            default: v = va_arg(ap, int); break;
+            }
+            room = room && put(binlog::arg_int, &v, sizeof(v));
+        } else if (binlog::is_unsigned_conversion(c)) {
+            uint64_t v;
+            switch (spec.length) {
+            case 'l': v = va_arg(ap, unsigned long); break;
+            case 'L': v = va_arg(ap, unsigned long long); break;
+            case 'z': v = va_arg(ap, size_t); break;
+            case 'j': v = va_arg(ap, uintmax_t); break;
+            case 't': v = static_cast<uint64_t>(va_arg(ap, ptrdiff_t)); break;
+            default: v = va_arg(ap, unsigned int); break;
+            }
+            room = room && put(binlog::arg_uint, &v, sizeof(v));
+        } else if (binlog::is_float_conversion(c)) {
+            double v = spec.length == 'D' ? static_cast<double>(va_arg(ap, long double)) : va_arg(ap, double);
+            room = room && put(binlog::arg_double, &v, sizeof(v));
+        } else if (c == 'p') {
+            uint64_t v = reinterpret_cast<uintptr_t>(va_arg(ap, void*));
+            room = room && put(binlog::arg_pointer, &v, sizeof(v));
+        } else if (c == 's') {
+            const char* s = va_arg(ap, const char*);
+            if (!s) s = "(null)";
+            if (used + 3 > capacity) break;
+            uint16_t n = static_cast<uint16_t>(std::min(std::strlen(s), capacity - used - 3));
+            room = put(binlog::arg_string, &n, sizeof(n));
+            std::memcpy(out + used, s, n);
+            used += n;
+        } else if (c == 'n') {
+            (void)va_arg(ap, void*);
+        } else {
+            break; // unbekannte Umwandlung, Rest nicht raten
+        }
+    }
+    return static_cast<uint32_t>(used);
+}
+
+void put_bytes(const void* data, size_t n) {
+    g_log.write(static_cast<const char*>(data), static_cast<std::streamsize>(n));
+    g_file_bytes += n;
+}
+
+uint16_t format_id(const char* fmt, LogLevel level, LogTag tag) {
+    FormatKey key{fmt, level, tag};
+    auto it = g_format_ids.find(key);
+    if (it != g_format_ids.end()) return it->second;
+
+    if (g_format_ids.size() > 0xFFFF) g_format_ids.clear(); // IDs neu vergeben, spätere Einträge ersetzen frühere
+    uint16_t id = static_cast<uint16_t>(g_format_ids.size());
+    g_format_ids.emplace(key, id);
+
+    const char* tag_name = tag_names[static_cast<size_t>(tag)];
+    uint8_t type = binlog::record_format;
+    uint8_t lvl = static_cast<uint8_t>(level);
+    uint8_t tag_len = static_cast<uint8_t>(std::strlen(tag_name));
+    uint16_t fmt_len = static_cast<uint16_t>(std::min<size_t>(std::strlen(fmt), 0xFFFF));
+    put_bytes(&type, 1);
+    put_bytes(&id, sizeof(id));
+    put_bytes(&lvl, 1);
+    put_bytes(&tag_len, 1);
+    put_bytes(tag_name, tag_len);
+    put_bytes(&fmt_len, sizeof(fmt_len));
+    put_bytes(fmt, fmt_len);
+    return id;
+}
+
+void write_entry(int64_t time_us, LogLevel level, LogTag tag, const char* fmt, const char* args, uint32_t length) {
+    uint16_t id = format_id(fmt, level, tag);
+    uint8_t type = binlog::record_entry;
+    uint16_t args_len = static_cast<uint16_t>(length);
+    put_bytes(&type, 1);
+    put_bytes(&id, sizeof(id));
+    put_bytes(&time_us, sizeof(time_us));
+    put_bytes(&args_len, sizeof(args_len));
+    put_bytes(args, args_len);
+}
+
+void write_line(int64_t time_us, LogLevel level, LogTag tag, const char* text, size_t length) {
+    int64_t second = time_us / 1000000;
+    if (second != g_stamp_second) {
+        std::time_t t = static_cast<std::time_t>(second);
+        std::tm tm_local{};
+#ifdef _WIN32
+        localtime_s(&tm_local, &t);
+#else
+        localtime_r(&t, &tm_local);
+#endif
+        std::strftime(g_stamp, sizeof(g_stamp), "%Y-%m-%d %H:%M:%S", &tm_local);
+        g_stamp_second = second;
+    }
+    char prefix[64];
+    int n = std::snprintf(prefix, sizeof(prefix), ".%03d %s[%s] ", static_cast<int>((time_us / 1000) % 1000),
+                          level_columns[static_cast<size_t>(level)], tag_names[static_cast<size_t>(tag)]);
+    g_log << g_stamp;
+    g_log.write(prefix, n);
+    g_log.write(text, static_cast<std::streamsize>(length));
+    g_log.put('\n');
+    g_file_bytes += std::strlen(g_stamp) + static_cast<size_t>(n) + length + 1;
+}
+
+// Meldungen des Loggers selbst, in beiden Formaten
+void write_message(LogLevel level, const char* text) {
+    if (!g_log.is_open()) return;
+    if (!g_file_binary) {
+        write_line(now_us(), level, LogTag::log, text, std::strlen(text));
+        return;
+    }
+    char args[log_text_size];
+    uint16_t n = static_cast<uint16_t>(std::min(std::strlen(text), sizeof(args) - 3));
+    args[0] = static_cast<char>(binlog::arg_string);
+    std::memcpy(args + 1, &n, sizeof(n));
+    std::memcpy(args + 3, text, n);
+    write_entry(now_us(), level, LogTag::log, "%s", args, n + 3u);
+}
+
+std::string current_path() {
+    if (!g_file_binary) return g_text_path;
+    return std::filesystem::path(g_text_path).replace_extension(".binlog").string();
+}
+
+// plugin_debug.log -> plugin_debug.log.1 -> ... -> .<keep>, ältere werden gelöscht
+void rotate_files(const std::string& path) {
+    std::error_code ec;
+    if (g_keep <= 0) {
+        std::filesystem::remove(path, ec);
+        return;
+    }
+    std::filesystem::remove(path + "." + std::to_string(g_keep), ec);
+    for (int i = g_keep - 1; i >= 1; --i) {
+        std::filesystem::rename(path + "." + std::to_string(i), path + "." + std::to_string(i + 1), ec);
+    }
+    std::filesystem::rename(path, path + ".1", ec);
+}
 
-static std::ofstream g_log;
-static std::mutex g_log_mutex;
+// Öffnet die Datei für das aktuelle Format; ist sie schon zu groß, wird vorher rotiert
+void open_file() {
+    std::string path = current_path();
+    std::error_code ec;
+    uint64_t size = std::filesystem::exists(path, ec) ? std::filesystem::file_size(path, ec) : 0;
+    if (ec) size = 0;
+    if (g_max_bytes > 0 && size >= g_max_bytes) {
+        rotate_files(path);
+        size = 0;
+    }
+
+    g_log.open(path, std::ios::out | std::ios::app | (g_file_binary ? std::ios::binary : std::ios::openmode()));
+    g_file_bytes = size;
+    g_format_ids.clear();
+    if (g_log.is_open() && g_file_binary && size == 0) {
+        put_bytes(binlog::magic, sizeof(binlog::magic));
+        put_bytes(&binlog::version, 1);
+    }
+}
+
+void rotate_if_needed() {
+    if (g_max_bytes == 0 || g_file_bytes < g_max_bytes || !g_log.is_open()) return;
+    g_log.close();
+    open_file(); // rotiert, weil die Datei jetzt zu groß ist
+}
+
+// Nur unter g_write_mutex: alles Fertige aus dem Ring in die Datei
+void drain_locked() {
+    bool wrote = false;
+    size_t pos = g_ring.dequeue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+        LogRecord& rec = g_ring.records[pos & (log_capacity - 1)];
+        if (rec.sequence.load(std::memory_order_acquire) != pos + 1) break;
+        if (g_log.is_open()) {
+            if (rec.binary == g_file_binary) {
+                if (rec.binary) {
+                    write_entry(rec.time_us, rec.level, rec.tag, rec.fmt, rec.text, rec.length);
+                } else {
+                    write_line(rec.time_us, rec.level, rec.tag, rec.text, rec.length);
+                }
+            } else if (rec.binary) {
+                // Beim Umschalten des Formats noch unterwegs
+                std::string text;
+                binlog::format_args(rec.fmt, rec.text, rec.length, text);
+                write_line(rec.time_us, rec.level, rec.tag, text.data(), text.size());
+            } else {
+                char args[log_text_size];
+                uint16_t n = static_cast<uint16_t>(std::min<size_t>(rec.length, sizeof(args) - 3));
+                args[0] = static_cast<char>(binlog::arg_string);
+                std::memcpy(args + 1, &n, sizeof(n));
+                std::memcpy(args + 3, rec.text, n);
+                write_entry(rec.time_us, rec.level, rec.tag, "%s", args, n + 3u);
+            }
+        }
+        rec.sequence.store(pos + log_capacity, std::memory_order_release);
+        g_ring.dequeue_pos.store(++pos, std::memory_order_relaxed);
+        wrote = true;
+    }
+    uint64_t dropped = g_dropped.load(std::memory_order_relaxed);
+    if (dropped != g_dropped_reported && g_log.is_open()) {
+        char text[96];
+        std::snprintf(text, sizeof(text), "%llu lines dropped, log ring was full.",
+                      static_cast<unsigned long long>(dropped - g_dropped_reported));
+        write_message(LogLevel::warn, text);
+        g_dropped_reported = dropped;
+        wrote = true;
+    }
+    if (wrote && g_log.is_open()) {
+        g_log.flush();
+        rotate_if_needed();
+    }
+}
 
-static std::string timestamp_now() {
-    using namespace std::chrono;
-    auto now = system_clock::now();
-    auto t = system_clock::to_time_t(now);
-    auto ms = duration_cast<milliseconds>(now.time_since_epoch()) % 1000;
-    std::ostringstream ss;
-    ss << std::put_time(std::localtime(&t), "%Y-%m-%d %H:%M:%S")
-       << "." << std::setw(3) << std::setfill('0') << ms.count();
-    return ss.str();
+void writer_main() {
+    std::unique_lock<std::mutex> wake_lock(g_wake_mutex);
+    while (!g_stop) {
+        g_wake.wait_for(wake_lock, log_interval);
+        std::lock_guard<std::mutex> lk(g_write_mutex);
+        drain_locked();
+        usage_sample_thread(UsageThread::log_writer);
+    }
+}
+
+void stop_writer() {
+    if (!g_writer.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lk(g_wake_mutex);
+        g_stop = true;
+    }
+    g_wake.notify_one();
+    g_writer.join();
 }
 
+} // namespace
+
+std::atomic<uint8_t> plugin_log_thresholds[static_cast<size_t>(LogTag::count)] = {
+    {2}, {2}, {2}, {2}, {2}, {2}, {2}, {2}, {2}, {2}};
+
 void plugin_log_init(const std::string& path) {
-    std::lock_guard<std::mutex> lk(g_log_mutex);
-    if (g_log.is_open()) g_log.close();
-    g_log.open(path, std::ios::out | std::ios::app);
-    if (g_log.is_open()) {
-        g_log << timestamp_now() << " === plugin_log started ===\n";
+    plugin_log_close();
+    {
+        std::lock_guard<std::mutex> lk(g_write_mutex);
+        g_text_path = path;
+        g_file_binary = g_binary.load(std::memory_order_relaxed);
+        open_file();
+        if (!g_log.is_open()) return;
+        write_message(LogLevel::info, "=== plugin_log started ===");
         g_log.flush();
     }
+    g_stop = false;
+    g_writer = std::thread(writer_main);
+    g_open.store(true, std::memory_order_release);
 }
 
-void plugin_log_printf(const char* fmt, ...) {
-    std::lock_guard<std::mutex> lk(g_log_mutex);
-    if (!g_log.is_open()) return;
-    char buf[2048];
+void plugin_log_configure(bool binary, uint64_t max_bytes, int keep) {
+    std::lock_guard<std::mutex> lk(g_write_mutex);
+    g_max_bytes = max_bytes;
+    g_keep = keep;
+    if (binary == g_file_binary || !g_log.is_open()) {
+        g_binary.store(binary, std::memory_order_relaxed);
+        g_file_binary = binary;
+        rotate_if_needed();
+        return;
+    }
+
+    // Format wechseln: bisherige Zeilen noch in die alte Datei, dann die andere öffnen
+    drain_locked();
+    write_message(LogLevel::info, binary ? "Continuing in binary log (.binlog)." : "Continuing in text log.");
+    g_log.close();
+    g_file_binary = binary;
+    g_binary.store(binary, std::memory_order_relaxed);
+    open_file();
+    write_message(LogLevel::info, "=== plugin_log started ===");
+    g_log.flush();
+}
+
+void plugin_log_write(LogLevel level, LogTag tag, const char* fmt, ...) {
+    if (!g_open.load(std::memory_order_acquire)) return;
+
+    // Platz im Ring reservieren (mehrere Erzeuger, wartet nie)
+    size_t pos = g_ring.enqueue_pos.load(std::memory_order_relaxed);
+    LogRecord* rec;
+    for (;;) {
+        rec = &g_ring.records[pos & (log_capacity - 1)];
+        size_t seq = rec->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (g_ring.enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            g_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = g_ring.enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    rec->time_us = now_us();
+    rec->level = level;
+    rec->tag = tag;
+    rec->binary = g_binary.load(std::memory_order_relaxed);
+    rec->fmt = fmt;
     va_list ap;
     va_start(ap, fmt);
-    vsnprintf(buf, sizeof(buf), fmt, ap);
+    if (rec->binary) {
+        rec->length = pack_args(rec->text, log_text_size, fmt, ap);
+    } else {
+        int n = vsnprintf(rec->text, log_text_size, fmt, ap);
+        rec->length = n < 0 ? 0 : static_cast<uint32_t>(std::min<size_t>(static_cast<size_t>(n), log_text_size - 1));
+    }
     va_end(ap);
-    g_log << timestamp_now() << " " << buf << '\n';
-    g_log.flush();
+    rec->sequence.store(pos + 1, std::memory_order_release);
+
+    // Nur wenn sich Zeilen stauen, den Schreib-Thread vor Ablauf des Takts wecken
+    if (pos + 1 - g_ring.dequeue_pos.load(std::memory_order_relaxed) == log_capacity / 2) g_wake.notify_one();
 }
 
 void plugin_log_flush() {
-    std::lock_guard<std::mutex> lk(g_log_mutex);
-    if (g_log.is_open()) g_log.flush();
+    std::lock_guard<std::mutex> lk(g_write_mutex);
+    drain_locked();
 }
 
 void plugin_log_close() {
-    std::lock_guard<std::mutex> lk(g_log_mutex);
+    g_open.store(false, std::memory_order_release);
+    stop_writer();
+    std::lock_guard<std::mutex> lk(g_write_mutex);
+    drain_locked();
     if (g_log.is_open()) {
-        g_log << timestamp_now() << " === plugin_log stopped ===\n";
+        write_message(LogLevel::info, "=== plugin_log stopped ===");
         g_log.close();
     }
-}
\ No newline at end of file
+}
+
+uint64_t plugin_log_dropped() {
+    return g_dropped.load(std::memory_order_relaxed);
+}
+
+void plugin_log_set_level(LogLevel level, LogTag tag) {
+    for (size_t i = 0; i < static_cast<size_t>(LogTag::count); ++i) {
+        if (tag == LogTag::count || static_cast<size_t>(tag) == i) {
+            plugin_log_thresholds[i].store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+        }
+    }
+}
+
+bool plugin_log_parse_level(const std::string& name, LogLevel& level) {
+    for (uint8_t i = 0; i <= static_cast<uint8_t>(LogLevel::off); ++i) {
+        if (equals_ignore_case(name, plugin_log_level_name(static_cast<LogLevel>(i)))) {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool plugin_log_parse_tag(const std::string& name, LogTag& tag) {
+    for (size_t i = 0; i < static_cast<size_t>(LogTag::count); ++i) {
+        if (equals_ignore_case(name, tag_names[i])) {
+            tag = static_cast<LogTag>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* plugin_log_level_name(LogLevel level) {
+    static const char* const names[] = {"trace", "debug", "info", "warn", "error", "off"};
+    return names[static_cast<size_t>(level)];
+}
+
+// Geschlossen wird ausdrücklich in scs_telemetry_shutdown. Dieser Destruktor läuft
+// beim Entladen der DLL unter der Loader-Sperre, dort darf kein Thread gejoint
+// werden: ein vergessener Schreib-Thread wird nur angehalten und losgelassen.
+static struct PluginLogShutdown {
+    ~PluginLogShutdown() {
+        assert(!g_writer.joinable() && "plugin_log_close() not called before unload");
+        if (!g_writer.joinable()) return;
+        g_open.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lk(g_wake_mutex);
+            g_stop = true;
+        }
+        g_wake.notify_one();
+        g_writer.detach();
+    }
+} g_log_shutdown;
\ No newline at end of file
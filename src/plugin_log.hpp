@@ -1,7 +1,78 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
 #include <string>
 
+// plugin_log wartet nie auf die Festplatte: die Zeile landet in einem Ring,
+// ein eigener Thread schreibt gesammelt. plugin_log_flush() schreibt sofort.
+// Im Binärformat wird auch nicht mehr formatiert, siehe log_format.hpp.
+//
+// Geloggt wird über die Makros PLOG_TRACE ... PLOG_ERROR mit einem Subsystem:
+//   PLOG_WARN(config, "Invalid %s value '%s'.", key.c_str(), value.c_str());
+// Stufen unter SCS_WS_LOG_COMPILE_LEVEL werden gar nicht erst übersetzt, die
+// Laufzeitschwelle (log_level in der INI, pro Subsystem überschreibbar) wird
+// geprüft, bevor ein Argument ausgewertet wird.
+
+enum class LogLevel : uint8_t { trace, debug, info, warn, error, off };
+
+// Reihenfolge = Index in plugin_log_thresholds
+enum class LogTag : uint8_t { plugin, config, ws, http, sse, stream, udp, shm, journal, log, count };
+
+// Ohne Vorgabe: Debug-Builds behalten alles, Release-Builds ab info
+#ifndef SCS_WS_LOG_COMPILE_LEVEL
+#ifdef NDEBUG
+#define SCS_WS_LOG_COMPILE_LEVEL 2
+#else
+#define SCS_WS_LOG_COMPILE_LEVEL 0
+#endif
+#endif
+
+constexpr int plugin_log_compile_level = SCS_WS_LOG_COMPILE_LEVEL;
+
+constexpr bool plugin_log_compiled(LogLevel level) {
+    return static_cast<int>(level) >= plugin_log_compile_level;
+}
+
+extern std::atomic<uint8_t> plugin_log_thresholds[static_cast<size_t>(LogTag::count)];
+
+inline bool plugin_log_enabled(LogLevel level, LogTag tag) {
+    return static_cast<uint8_t>(level) >= plugin_log_thresholds[static_cast<size_t>(tag)].load(std::memory_order_relaxed);
+}
+
+#define PLOG(level, tag, ...)                                                                        \
+    do {                                                                                             \
+        if constexpr (plugin_log_compiled(LogLevel::level)) {                                        \
+            if (plugin_log_enabled(LogLevel::level, LogTag::tag)) {                                  \
+                plugin_log_write(LogLevel::level, LogTag::tag, __VA_ARGS__);                         \
+            }                                                                                        \
+        }                                                                                            \
+    } while (0)
+
+#define PLOG_TRACE(tag, ...) PLOG(trace, tag, __VA_ARGS__)
+#define PLOG_DEBUG(tag, ...) PLOG(debug, tag, __VA_ARGS__)
+#define PLOG_INFO(tag, ...) PLOG(info, tag, __VA_ARGS__)
+#define PLOG_WARN(tag, ...) PLOG(warn, tag, __VA_ARGS__)
+#define PLOG_ERROR(tag, ...) PLOG(error, tag, __VA_ARGS__)
+
 void plugin_log_init(const std::string& path);
-void plugin_log_printf(const char* fmt, ...);
+void plugin_log_write(LogLevel level, LogTag tag, const char* fmt, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 3, 4)))
+#endif
+    ;
 void plugin_log_flush();
-void plugin_log_close();
\ No newline at end of file
+
+// Dateiformat und Rotation (aus der INI, nach plugin_log_init). Binär schreibt
+// nach <Pfad ohne Endung>.binlog, lesbar mit tools/log_decode. max_bytes 0 =
+// nie rotieren, sonst bleiben keep ältere Dateien (.1 ... .keep) erhalten.
+void plugin_log_configure(bool binary, uint64_t max_bytes, int keep);
+void plugin_log_close();
+uint64_t plugin_log_dropped(); // Zeilen, die wegen vollem Ring verworfen wurden
+
+// Laufzeitschwelle für ein Subsystem oder (tag = count) für alle
+void plugin_log_set_level(LogLevel level, LogTag tag = LogTag::count);
+
+// "trace" ... "error", "off" bzw. Subsystem-Namen wie "ws" (Groß-/Kleinschreibung egal)
+bool plugin_log_parse_level(const std::string& name, LogLevel& level);
+bool plugin_log_parse_tag(const std::string& name, LogTag& tag);
+const char* plugin_log_level_name(LogLevel level);
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include "plugin_metrics.hpp"
+
+#include <cstdio>
+
+PluginMetrics g_metrics;
+
+void MetricsWriter::describe(const char* name, const char* type, const char* help) {
+    m_out += "# HELP ";
+    m_out += name;
+    m_out += ' ';
+    m_out += help;
+    m_out += "\n# TYPE ";
+    m_out += name;
+    m_out += ' ';
+    m_out += type;
+    m_out += '\n';
+}
+
+void MetricsWriter::begin(const char* name, const std::string& labels) {
+    m_out += name;
+    if (!labels.empty()) {
+        m_out += '{';
+        m_out += labels;
+        m_out += '}';
+    }
+    m_out += ' ';
+}
+
+void MetricsWriter::value(const char* name, const std::string& labels, double value) {
+    begin(name, labels);
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g\n", value);
+    m_out += buf;
+}
+
+void MetricsWriter::value(const char* name, const std::string& labels, uint64_t value) {
+    begin(name, labels);
+    m_out += std::to_string(value);
+    m_out += '\n';
+}
+
+void MetricsWriter::counter(const char* name, const char* help, uint64_t value) {
+    describe(name, "counter", help);
+    this->value(name, std::string(), value);
+}
+
+void MetricsWriter::gauge(const char* name, const char* help, double value) {
+    describe(name, "gauge", help);
+    this->value(name, std::string(), value);
+}
@@ -0,0 +1,51 @@
+#pragma once
+// Zähler für GET /metrics (Prometheus-Textformat). Erhöht wird nur mit relaxed
+// atomics, der Spiel-Thread nimmt dafür keine Sperre; gelesen wird beim Abruf.
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+struct PluginMetrics {
+    // Spiel-Thread
+    std::atomic<uint64_t> frames_ingested{0};     // frame_end-Aufrufe
+    std::atomic<uint64_t> messages_encoded{0};    // kodierte Nachrichten aller Arten
+    std::atomic<uint64_t> frames_coalesced{0};    // wegen des Frame-Budgets nicht veröffentlicht (im nächsten enthalten)
+    std::atomic<uint64_t> frame_budget_exceeded{0};
+    std::atomic<uint64_t> frame_budget_steps{0};  // Stufenwechsel in beide Richtungen
+    std::atomic<uint32_t> frame_budget_level{0};
+
+    // WebSocket-Shards, nach Format
+    std::atomic<uint64_t> messages_sent_json{0};
+    std::atomic<uint64_t> bytes_sent_json{0};
+    std::atomic<uint64_t> messages_sent_msgpack{0};
+    std::atomic<uint64_t> bytes_sent_msgpack{0};
+
+    // Summe über alle (auch schon getrennte) Verbindungen
+    std::atomic<uint64_t> frames_skipped{0};      // wegen rate/Drosselung ausgelassen, der nächste Voll-Frame ersetzt sie
+    std::atomic<uint64_t> frames_dropped{0};      // aus der Spur eines langsamen Clients verworfen
+};
+
+extern PluginMetrics g_metrics;
+
+// Schreibt Zeilen im Prometheus-Textformat (Version 0.0.4)
+class MetricsWriter {
+public:
+    explicit MetricsWriter(std::string& out) : m_out(out) {}
+
+    // # HELP und # TYPE, einmal pro Metrik vor den Werten
+    void describe(const char* name, const char* type, const char* help);
+
+    // name{labels} value; labels ohne Klammern, z.B. "format=\"json\"", leer = keine
+    void value(const char* name, const std::string& labels, double value);
+    void value(const char* name, const std::string& labels, uint64_t value);
+
+    // Kurzform für Metriken mit genau einem Wert ohne Labels
+    void counter(const char* name, const char* help, uint64_t value);
+    void gauge(const char* name, const char* help, double value);
+
+private:
+    void begin(const char* name, const std::string& labels);
+
+    std::string& m_out;
+};
@@ -0,0 +1,108 @@
+#pragma once
+// Benannter Shared-Memory-Bereich (Windows: File Mapping, sonst POSIX shm).
+// Header-only, damit die Leser-Bibliothek ohne das Plugin gebaut werden kann.
+
+#include <cstddef>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class SharedMemoryMapping {
+public:
+    SharedMemoryMapping() = default;
+    ~SharedMemoryMapping() { close(); }
+
+    SharedMemoryMapping(const SharedMemoryMapping&) = delete;
+    SharedMemoryMapping& operator=(const SharedMemoryMapping&) = delete;
+
+    // Legt den Bereich an (Schreiber). Inhalt ist danach mit Nullen gefüllt.
+    bool create(const std::string& name, size_t size) {
+        close();
+#ifdef _WIN32
+        std::string full = "Local\\" + name;
+        m_handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                      static_cast<DWORD>(static_cast<unsigned long long>(size) >> 32),
+                                      static_cast<DWORD>(size & 0xFFFFFFFFu), full.c_str());
+        if (!m_handle) return false;
+        m_data = MapViewOfFile(m_handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+        if (!m_data) { close(); return false; }
+#else
+        m_name = "/" + name;
+        shm_unlink(m_name.c_str()); // Reste einer abgestürzten Sitzung entfernen
+        int fd = shm_open(m_name.c_str(), O_CREAT | O_RDWR, 0644);
+        if (fd < 0) return false;
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) { ::close(fd); shm_unlink(m_name.c_str()); return false; }
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) { shm_unlink(m_name.c_str()); return false; }
+        m_data = p;
+        m_owner = true;
+#endif
+        m_size = size;
+        return true;
+    }
+
+    // Öffnet einen vorhandenen Bereich (Leser)
+    bool open(const std::string& name, bool writable = false) {
+        close();
+#ifdef _WIN32
+        std::string full = "Local\\" + name;
+        DWORD access = writable ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ;
+        m_handle = OpenFileMappingA(access, FALSE, full.c_str());
+        if (!m_handle) return false;
+        m_data = MapViewOfFile(m_handle, access, 0, 0, 0);
+        if (!m_data) { close(); return false; }
+        MEMORY_BASIC_INFORMATION info{};
+        VirtualQuery(m_data, &info, sizeof(info));
+        m_size = info.RegionSize;
+#else
+        std::string full = "/" + name;
+        int fd = shm_open(full.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+        if (fd < 0) return false;
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return false; }
+        void* p = mmap(nullptr, static_cast<size_t>(st.st_size), writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        m_data = p;
+        m_size = static_cast<size_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_handle) CloseHandle(m_handle);
+        m_handle = nullptr;
+#else
+        if (m_data) munmap(m_data, m_size);
+        if (m_owner) shm_unlink(m_name.c_str());
+        m_owner = false;
+        m_name.clear();
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    void* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool is_open() const { return m_data != nullptr; }
+
+private:
+    void* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    HANDLE m_handle = nullptr;
+#else
+    std::string m_name;
+    bool m_owner = false;
+#endif
+};
@@ -0,0 +1,86 @@
+#pragma once
+// Versioniertes Speicherlayout des Shared-Memory-Rings.
+// Wird vom Plugin (Schreiber) und von shm_ring_reader.hpp (Leser) gemeinsam benutzt.
+//
+//   [ShmRingHeader][slot_count x (ShmRingSlot + slot_size Bytes)][ShmSnapshotHeader + snapshot_capacity Bytes]
+//
+// Ein Schreiber, beliebig viele Leser. Jeder Slot und der Snapshot sind per
+// Seqlock geschützt: ungerader Zähler = Schreibvorgang läuft.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace shm_ring {
+
+constexpr uint32_t magic = 0x52534353;   // "SCSR"
+constexpr uint32_t version = 1;
+constexpr size_t cache_line = 64;
+
+enum class PayloadFormat : uint32_t {
+    json = 0,
+    msgpack = 1,
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory needs address-free 64 bit atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared memory needs address-free 32 bit atomics");
+
+struct alignas(cache_line) ShmRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;        // sizeof(ShmRingHeader)
+    uint32_t slot_count;         // Anzahl Slots (Zweierpotenz)
+    uint32_t slot_size;          // Nutzdaten-Kapazität pro Slot in Bytes
+    uint32_t snapshot_capacity;  // Nutzdaten-Kapazität des Snapshots in Bytes
+    PayloadFormat format;
+    std::atomic<uint32_t> writer_alive; // 1 solange das Plugin läuft (release beim Setzen)
+
+    // Anzahl bisher veröffentlichter Slots (monoton steigend)
+    alignas(cache_line) std::atomic<uint64_t> write_index;
+    // Frames, die nicht in einen Slot gepasst haben
+    std::atomic<uint64_t> oversize_dropped;
+};
+
+struct alignas(cache_line) ShmRingSlot {
+    std::atomic<uint64_t> lock;  // Seqlock
+    uint64_t index;              // Ring-Position, die dieser Slot gerade hält
+    uint64_t seq;                // Sequenznummer des Frames
+    uint32_t kind;               // MessageKind
+    uint32_t size;               // Nutzdaten in Bytes
+    // danach: slot_size Bytes Nutzdaten
+};
+
+struct alignas(cache_line) ShmSnapshotHeader {
+    std::atomic<uint64_t> lock;  // Seqlock
+    uint64_t seq;
+    uint32_t size;
+    uint32_t reserved;
+    // danach: snapshot_capacity Bytes Nutzdaten
+};
+
+inline size_t slot_stride(uint32_t slot_size) {
+    size_t raw = sizeof(ShmRingSlot) + slot_size;
+    return (raw + cache_line - 1) & ~(cache_line - 1);
+}
+
+inline size_t snapshot_offset(uint32_t slot_count, uint32_t slot_size) {
+    return sizeof(ShmRingHeader) + static_cast<size_t>(slot_count) * slot_stride(slot_size);
+}
+
+inline size_t total_size(uint32_t slot_count, uint32_t slot_size, uint32_t snapshot_capacity) {
+    return snapshot_offset(slot_count, slot_size) + sizeof(ShmSnapshotHeader) + snapshot_capacity;
+}
+
+inline ShmRingSlot* slot_at(void* base, const ShmRingHeader& h, uint64_t index) {
+    size_t i = static_cast<size_t>(index & (h.slot_count - 1));
+    return reinterpret_cast<ShmRingSlot*>(static_cast<char*>(base) + sizeof(ShmRingHeader) + i * slot_stride(h.slot_size));
+}
+
+inline ShmSnapshotHeader* snapshot_at(void* base, const ShmRingHeader& h) {
+    return reinterpret_cast<ShmSnapshotHeader*>(static_cast<char*>(base) + snapshot_offset(h.slot_count, h.slot_size));
+}
+
+inline char* payload_of(ShmRingSlot* s) { return reinterpret_cast<char*>(s + 1); }
+inline char* payload_of(ShmSnapshotHeader* s) { return reinterpret_cast<char*>(s + 1); }
+
+} // namespace shm_ring
@@ -0,0 +1,131 @@
+#pragma once
+// Kleine Header-only Leser-Bibliothek für den Shared-Memory-Ring des Plugins.
+// Benötigt nur shm_mapping.hpp und shm_ring_layout.hpp.
+//
+//   ShmRingReader reader;
+//   if (reader.open("scs_ws_ring")) {
+//       reader.read_next([](const ShmRingReader::View& v) { /* v.data, v.size */ });
+//   }
+//
+// Lesen erfolgt ohne Systemaufrufe direkt im gemappten Speicher. Die View zeigt
+// auf den Slot selbst (keine Kopie); sie gilt nur, wenn read_next() danach
+// ReadResult::ok liefert - sonst wurde der Slot währenddessen überschrieben.
+
+#include "shm_mapping.hpp"
+#include "shm_ring_layout.hpp"
+
+#include <cstdint>
+#include <string>
+
+class ShmRingReader {
+public:
+    struct View {
+        uint64_t seq;
+        uint32_t kind;
+        const char* data;
+        uint32_t size;
+    };
+
+    enum class ReadResult {
+        ok,       // Frame gelesen
+        empty,    // Keine neuen Frames
+        overrun,  // Leser war zu langsam, Position wurde nachgezogen (lost() gibt Auskunft)
+        retry,    // Schreiber war gerade im Slot, später erneut versuchen
+    };
+
+    bool open(const std::string& name) {
+        if (!m_mapping.open(name)) return false;
+        if (m_mapping.size() < sizeof(shm_ring::ShmRingHeader)) { m_mapping.close(); return false; }
+        m_header = static_cast<shm_ring::ShmRingHeader*>(m_mapping.data());
+        if (m_header->magic != shm_ring::magic || m_header->version != shm_ring::version ||
+            m_header->header_size != sizeof(shm_ring::ShmRingHeader) ||
+            m_mapping.size() < shm_ring::total_size(m_header->slot_count, m_header->slot_size, m_header->snapshot_capacity)) {
+            close();
+            return false;
+        }
+        // Ab dem aktuellen Stand lesen
+        m_read_index = m_header->write_index.load(std::memory_order_acquire);
+        return true;
+    }
+
+    void close() {
+        m_header = nullptr;
+        m_mapping.close();
+    }
+
+    bool is_open() const { return m_header != nullptr; }
+    bool writer_alive() const { return m_header && m_header->writer_alive.load(std::memory_order_acquire) != 0; }
+    shm_ring::PayloadFormat format() const { return m_header->format; }
+    uint64_t lost() const { return m_lost; }
+
+    // Liest das nächste Frame ohne Kopie. fn(const View&) wird aufgerufen; ihr Ergebnis ist nur
+    // gültig, wenn ReadResult::ok zurückkommt.
+    template <typename Fn>
+    ReadResult read_next(Fn&& fn) {
+        uint64_t written = m_header->write_index.load(std::memory_order_acquire);
+        if (m_read_index >= written) return ReadResult::empty;
+        if (written - m_read_index > m_header->slot_count) {
+            uint64_t newest_safe = written - m_header->slot_count;
+            m_lost += newest_safe - m_read_index;
+            m_read_index = newest_safe;
+            return ReadResult::overrun;
+        }
+
+        auto* slot = shm_ring::slot_at(m_mapping.data(), *m_header, m_read_index);
+        uint64_t l1 = slot->lock.load(std::memory_order_acquire);
+        if (l1 & 1) return ReadResult::retry;
+        if (slot->index != m_read_index) {
+            // Slot gehört bereits zu einer neueren Runde
+            m_lost += 1;
+            m_read_index += 1;
+            return ReadResult::overrun;
+        }
+
+        uint32_t size = slot->size;
+        if (size > m_header->slot_size) return ReadResult::retry;
+        View v{slot->seq, slot->kind, shm_ring::payload_of(slot), size};
+        fn(v);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->lock.load(std::memory_order_relaxed) != l1) {
+            m_lost += 1;
+            m_read_index += 1;
+            return ReadResult::overrun;
+        }
+        m_read_index += 1;
+        return ReadResult::ok;
+    }
+
+    // Variante mit Kopie, für Leser, die die Daten länger behalten wollen
+    ReadResult read_next(std::string& out, uint64_t& seq, uint32_t& kind) {
+        return read_next([&](const View& v) {
+            out.assign(v.data, v.size);
+            seq = v.seq;
+            kind = v.kind;
+        });
+    }
+
+    // Liest den letzten vollständigen Zustand. Wiederholt, bis eine konsistente Kopie vorliegt.
+    bool read_snapshot(std::string& out, uint64_t& seq, int max_attempts = 16) {
+        auto* snap = shm_ring::snapshot_at(m_mapping.data(), *m_header);
+        for (int attempt = 0; attempt < max_attempts; ++attempt) {
+            uint64_t l1 = snap->lock.load(std::memory_order_acquire);
+            if (l1 & 1) continue;
+            uint32_t size = snap->size;
+            if (size > m_header->snapshot_capacity) continue;
+            seq = snap->seq;
+            out.assign(shm_ring::payload_of(snap), size);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (snap->lock.load(std::memory_order_relaxed) == l1) {
+                return l1 != 0; // 0 = noch nie geschrieben
+            }
+        }
+        return false;
+    }
+
+private:
+    SharedMemoryMapping m_mapping;
+    shm_ring::ShmRingHeader* m_header = nullptr;
+    uint64_t m_read_index = 0;
+    uint64_t m_lost = 0;
+};
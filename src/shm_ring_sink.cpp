@@ -0,0 +1,113 @@
+#include "shm_ring_sink.hpp"
+#include "plugin_log.hpp"
+
+#include <cstring>
+#include <new>
+
+using namespace shm_ring;
+
+static uint32_t round_up_pow2(uint32_t v) {
+    uint32_t p = 1;
+    while (p < v && p < (1u << 20)) p <<= 1;
+    return p;
+}
+
+bool ShmRingSink::start(const PluginConfig& cfg) {
+    uint32_t slot_count = round_up_pow2(static_cast<uint32_t>(cfg.shm_slots > 0 ? cfg.shm_slots : 1));
+    uint32_t slot_size = static_cast<uint32_t>(cfg.shm_slot_size);
+    uint32_t snapshot_capacity = static_cast<uint32_t>(cfg.shm_snapshot_size);
+    size_t size = total_size(slot_count, slot_size, snapshot_capacity);
+
+    if (!m_mapping.create(cfg.shm_name, size)) {
+        PLOG_ERROR(shm, "Failed to create mapping '%s' (%zu bytes)", cfg.shm_name.c_str(), size);
+        return false;
+    }
+
+    m_use_msgpack = (cfg.shm_format == "msgpack");
+
+    // Placement-new für die atomaren Felder, der Rest ist bereits genullt
+    m_header = new (m_mapping.data()) ShmRingHeader();
+    m_header->magic = magic;
+    m_header->version = version;
+    m_header->header_size = sizeof(ShmRingHeader);
+    m_header->slot_count = slot_count;
+    m_header->slot_size = slot_size;
+    m_header->snapshot_capacity = snapshot_capacity;
+    m_header->format = m_use_msgpack ? PayloadFormat::msgpack : PayloadFormat::json;
+    for (uint32_t i = 0; i < slot_count; ++i) {
+        new (slot_at(m_mapping.data(), *m_header, i)) ShmRingSlot();
+    }
+    new (snapshot_at(m_mapping.data(), *m_header)) ShmSnapshotHeader();
+
+    // Erst zum Schluss als gültig markieren
+    m_header->writer_alive.store(1, std::memory_order_release);
+
+    PLOG_INFO(shm, "Ring '%s' created: %u slots x %u bytes, snapshot %u bytes, format=%s",
+              cfg.shm_name.c_str(), slot_count, slot_size, snapshot_capacity, m_use_msgpack ? "msgpack" : "json");
+    return true;
+}
+
+void ShmRingSink::stop() {
+    if (m_header) {
+        m_header->writer_alive.store(0, std::memory_order_release);
+        PLOG_INFO(shm, "Ring closed after %llu frames (%llu too large for a slot).",
+                  static_cast<unsigned long long>(m_header->write_index.load(std::memory_order_relaxed)),
+                  static_cast<unsigned long long>(m_header->oversize_dropped.load(std::memory_order_relaxed)));
+    }
+    m_header = nullptr;
+    m_mapping.close();
+}
+
+void ShmRingSink::write(const EncodedFrame& frame) {
+    if (!m_header) return;
+    const FrameBuffer& payload = m_use_msgpack ? frame.msgpack : frame.json;
+
+    if (frame.full_state) {
+        write_snapshot(frame, payload);
+    }
+    // Reine Snapshots landen nicht im Ring
+    if (frame.kind != MessageKind::snapshot) {
+        write_slot(frame, payload);
+    }
+}
+
+void ShmRingSink::write_slot(const EncodedFrame& frame, const FrameBuffer& payload) {
+    if (payload.size() > m_header->slot_size) {
+        m_header->oversize_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    uint64_t index = m_header->write_index.load(std::memory_order_relaxed);
+    ShmRingSlot* slot = slot_at(m_mapping.data(), *m_header, index);
+
+    uint64_t lock = slot->lock.load(std::memory_order_relaxed);
+    slot->lock.store(lock + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->index = index;
+    slot->seq = frame.seq;
+    slot->kind = static_cast<uint32_t>(frame.kind);
+    slot->size = static_cast<uint32_t>(payload.size());
+    std::memcpy(payload_of(slot), payload.data(), payload.size());
+
+    slot->lock.store(lock + 2, std::memory_order_release);
+    m_header->write_index.store(index + 1, std::memory_order_release);
+}
+
+void ShmRingSink::write_snapshot(const EncodedFrame& frame, const FrameBuffer& payload) {
+    if (payload.size() > m_header->snapshot_capacity) {
+        m_header->oversize_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ShmSnapshotHeader* snap = snapshot_at(m_mapping.data(), *m_header);
+    uint64_t lock = snap->lock.load(std::memory_order_relaxed);
+    snap->lock.store(lock + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    snap->seq = frame.seq;
+    snap->size = static_cast<uint32_t>(payload.size());
+    std::memcpy(payload_of(snap), payload.data(), payload.size());
+
+    snap->lock.store(lock + 2, std::memory_order_release);
+}
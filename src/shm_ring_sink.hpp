@@ -0,0 +1,27 @@
+#pragma once
+#include "config.hpp"
+#include "encoded_frame.hpp"
+#include "shm_mapping.hpp"
+#include "shm_ring_layout.hpp"
+
+#include <cstdint>
+
+// Optionaler Shared-Memory-Ausgang für Programme auf demselben Rechner.
+// Schreibt jedes Frame in einen Ring fester Slots und hält zusätzlich den
+// letzten vollständigen Zustand als Snapshot vor. Leser: shm_ring_reader.hpp
+class ShmRingSink {
+public:
+    bool start(const PluginConfig& cfg);
+    void stop();
+
+    // Läuft im Server-Thread (einziger Schreiber)
+    void write(const EncodedFrame& frame);
+
+private:
+    void write_slot(const EncodedFrame& frame, const FrameBuffer& payload);
+    void write_snapshot(const EncodedFrame& frame, const FrameBuffer& payload);
+
+    SharedMemoryMapping m_mapping;
+    shm_ring::ShmRingHeader* m_header = nullptr;
+    bool m_use_msgpack = false;
+};
@@ -0,0 +1,87 @@
+#include "snapshot_cache.hpp"
+#include "plugin_log.hpp"
+
+void SnapshotCache::on_frame(const EncodedFramePtr& frame) {
+    if (!frame) return;
+
+    if (frame->full_state) {
+        m_snapshot = frame;
+        return;
+    }
+
+    if (frame->kind == MessageKind::frame) {
+        // Delta: der Snapshot ist ab jetzt veraltet, bis der nächste kommt
+        m_last_change_seq = frame->seq;
+        return;
+    }
+
+    if (frame->kind == MessageKind::config) {
+        // Konfigurationen sind selten, parsen im Server-Thread ist hier unkritisch
+        try {
+            nlohmann::json msg = nlohmann::json::parse(frame->json);
+            const std::string id = msg.value("id", "");
+            if (!id.empty()) {
+                m_config_state[id] = msg.contains("attributes") ? msg["attributes"] : nlohmann::json::object();
+                m_config_seq = frame->seq;
+            }
+        } catch (const std::exception& e) {
+            PLOG_WARN(http, "Could not parse config message: %s", e.what());
+        }
+    }
+}
+
+bool SnapshotCache::snapshot_fresh() const {
+    return m_snapshot && m_snapshot->seq > m_last_change_seq;
+}
+
+const std::string& SnapshotCache::snapshot_body(const std::string& prefix) {
+    static const std::string empty = "{}";
+    if (!m_snapshot) return empty;
+
+    auto& cached = m_prefix_bodies[prefix];
+    if (cached.first == m_snapshot->seq && !cached.second.empty()) {
+        return cached.second;
+    }
+    if (prefix.empty()) {
+        // Frame-Puffer laufen über den zählenden Allokator, die Antwort braucht einen std::string
+        cached.first = m_snapshot->seq;
+        cached.second.assign(m_snapshot->json.data(), m_snapshot->json.size());
+        return cached.second;
+    }
+
+    if (m_parsed_seq != m_snapshot->seq) {
+        try {
+            m_parsed = nlohmann::json::parse(m_snapshot->json);
+        } catch (const std::exception& e) {
+            PLOG_WARN(http, "Could not parse snapshot: %s", e.what());
+            m_parsed = nlohmann::json::object();
+        }
+        m_parsed_seq = m_snapshot->seq;
+    }
+
+    nlohmann::json filtered = nlohmann::json::object();
+    for (auto it = m_parsed.begin(); it != m_parsed.end(); ++it) {
+        if (it.key().compare(0, prefix.size(), prefix) == 0) {
+            filtered[it.key()] = it.value();
+        }
+    }
+    cached.first = m_snapshot->seq;
+    cached.second = filtered.dump();
+
+    // Nicht unbegrenzt viele Präfixe aufheben
+    if (m_prefix_bodies.size() > 64) {
+        for (auto it = m_prefix_bodies.begin(); it != m_prefix_bodies.end();) {
+            if (it->second.first != m_snapshot->seq) it = m_prefix_bodies.erase(it);
+            else ++it;
+        }
+    }
+    return cached.second;
+}
+
+const std::string& SnapshotCache::config_body() {
+    if (m_config_body_seq != m_config_seq) {
+        m_config_body = m_config_state.dump();
+        m_config_body_seq = m_config_seq;
+    }
+    return m_config_body;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "encoded_frame.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+// Letzter vollständiger Zustand und letzte Konfiguration für die HTTP-Endpunkte.
+// Wird nur im Server-Thread benutzt. Antworten werden pro Sequenznummer (und
+// pro Präfix) höchstens einmal erzeugt, beliebig viele Anfragen teilen sie sich.
+class SnapshotCache {
+public:
+    // Jede verteilte Nachricht durchreichen
+    void on_frame(const EncodedFramePtr& frame);
+
+    // true, wenn der zwischengespeicherte Snapshot den neuesten Stand enthält
+    bool snapshot_fresh() const;
+    bool has_snapshot() const { return m_snapshot != nullptr; }
+    const EncodedFramePtr& snapshot() const { return m_snapshot; }
+    uint64_t snapshot_seq() const { return m_snapshot ? m_snapshot->seq : 0; }
+
+    // JSON des Snapshots, optional nur Schlüssel mit dem angegebenen Präfix
+    const std::string& snapshot_body(const std::string& prefix);
+
+    uint64_t config_seq() const { return m_config_seq; }
+    const std::string& config_body();
+
+private:
+    EncodedFramePtr m_snapshot;
+    uint64_t m_last_change_seq = 0;
+
+    // Für Präfix-Anfragen: einmal geparster Snapshot und gefilterte Antworten
+    uint64_t m_parsed_seq = 0;
+    nlohmann::json m_parsed;
+    std::map<std::string, std::pair<uint64_t, std::string>> m_prefix_bodies;
+
+    nlohmann::json m_config_state = nlohmann::json::object();
+    uint64_t m_config_seq = 0;
+    uint64_t m_config_body_seq = 0;
+    std::string m_config_body = "{}";
+};
@@ -0,0 +1,238 @@
+#include "sse_hub.hpp"
+#include "plugin_log.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <string>
+
+namespace asio = websocketpp::lib::asio;
+
+namespace {
+
+const char* event_name(MessageKind kind) {
+    switch (kind) {
+        case MessageKind::gameplay: return "gameplay";
+        case MessageKind::config:   return "config";
+        case MessageKind::snapshot: return "snapshot";
+        default:                    return "frame";
+    }
+}
+
+// "id: ...\nevent: ...\ndata: " - danach folgt der JSON-Puffer und "\n\n"
+std::shared_ptr<const std::string> make_head(const EncodedFrame& frame, const char* event) {
+    return std::make_shared<const std::string>("id: " + std::to_string(frame.seq) + "\nevent: " + event + "\ndata: ");
+}
+
+const char k_preamble[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "X-Accel-Buffering: no\r\n"
+    "\r\n"
+    "retry: 2000\n\n";
+
+const char k_tail[] = "\n\n";
+
+} // namespace
+
+class SseSession : public std::enable_shared_from_this<SseSession> {
+public:
+    using connection_ptr = SseHub::server_t::connection_ptr;
+
+    static constexpr size_t max_queue = 4096;
+
+    explicit SseSession(connection_ptr con) : m_con(std::move(con)), m_socket(m_con->get_raw_socket()) {}
+
+    void start() {
+        enqueue(std::make_shared<const std::string>(k_preamble), nullptr);
+        read_until_closed();
+    }
+
+    // body == nullptr: nur head schicken (Präambel, Kommentare)
+    void enqueue(std::shared_ptr<const std::string> head, EncodedFramePtr body) {
+        if (m_closed) return;
+        if (m_queue.size() >= max_queue) {
+            PLOG_WARN(sse, "Client is not reading, dropping connection.");
+            close();
+            return;
+        }
+        m_queue.push_back({std::move(head), std::move(body)});
+        if (!m_writing) write_next();
+    }
+
+    void close() {
+        if (m_closed) return;
+        m_closed = true;
+        m_queue.clear();
+        asio::error_code ec;
+        m_socket.shutdown(asio::socket_base::shutdown_both, ec);
+        // Die zurückgestellte Antwort abschließen, damit websocketpp die Verbindung freigibt
+        websocketpp::lib::error_code wec;
+        m_con->set_status(websocketpp::http::status_code::ok);
+        m_con->send_http_response(wec);
+    }
+
+    bool is_closed() const { return m_closed; }
+
+    bool waiting_for_snapshot = false;
+
+private:
+    struct Item {
+        std::shared_ptr<const std::string> head;
+        EncodedFramePtr body;
+    };
+
+    // Der Stream ist einseitig; gelesen wird nur, um das Schließen durch den Client zu bemerken
+    void read_until_closed() {
+        auto self = shared_from_this();
+        m_socket.async_read_some(asio::buffer(m_read_buf), [self](const asio::error_code& ec, size_t) {
+            if (self->m_closed) return;
+            if (ec) {
+                self->close();
+                return;
+            }
+            self->read_until_closed();
+        });
+    }
+
+    void write_next() {
+        if (m_closed || m_queue.empty()) {
+            m_writing = false;
+            return;
+        }
+        m_writing = true;
+        const Item& item = m_queue.front();
+
+        std::array<asio::const_buffer, 3> buffers = {
+            asio::buffer(item.head->data(), item.head->size()),
+            asio::const_buffer(),
+            asio::const_buffer(),
+        };
+        if (item.body) {
+            buffers[1] = asio::buffer(item.body->json.data(), item.body->json.size());
+            buffers[2] = asio::buffer(k_tail, 2);
+        }
+
+        auto self = shared_from_this();
+        asio::async_write(m_socket, buffers, [self](const asio::error_code& ec, size_t) {
+            if (ec) {
+                self->close();
+                return;
+            }
+            if (!self->m_queue.empty()) self->m_queue.pop_front();
+            self->write_next();
+        });
+    }
+
+    connection_ptr m_con;
+    asio::ip::tcp::socket& m_socket;
+    bool m_closed = false;
+    bool m_writing = false;
+    std::deque<Item> m_queue;
+    std::array<char, 256> m_read_buf{};
+};
+
+SseHub::SseHub() : m_last_keepalive(std::chrono::steady_clock::now()) {}
+
+SseHub::~SseHub() {
+    stop();
+}
+
+void SseHub::add(server_t::connection_ptr con, EncodedFramePtr snapshot) {
+    std::string last_event_id = con->get_request_header("Last-Event-ID");
+
+    auto session = std::make_shared<SseSession>(std::move(con));
+    session->start();
+    m_keep_history = true;
+
+    // Wiederaufnahme nur, wenn der Verlauf lückenlos an die letzte gesehene seq anschließt
+    bool resumed = false;
+    if (!last_event_id.empty() && !m_history.empty()) {
+        uint64_t last_seq = std::strtoull(last_event_id.c_str(), nullptr, 10);
+        if (last_seq >= m_history_floor && last_seq <= m_history.back().frame->seq) {
+            for (const auto& entry : m_history) {
+                if (entry.frame->seq > last_seq) session->enqueue(entry.head, entry.frame);
+            }
+            resumed = true;
+        }
+    }
+    if (!resumed) {
+        if (snapshot) {
+            session->enqueue(make_head(*snapshot, "snapshot"), snapshot);
+        } else {
+            session->waiting_for_snapshot = true;
+        }
+    }
+
+    m_sessions.push_back(std::move(session));
+    PLOG_INFO(sse, "Client connected%s. Total SSE clients: %zu", resumed ? " (resumed)" : "", m_sessions.size());
+}
+
+void SseHub::send(const EncodedFramePtr& frame) {
+    if (frame->kind == MessageKind::snapshot) {
+        // Snapshots gehen nur an Sitzungen, die noch keinen vollständigen Zustand haben
+        std::shared_ptr<const std::string> head;
+        for (auto& session : m_sessions) {
+            if (!session->waiting_for_snapshot) continue;
+            if (!head) head = make_head(*frame, "snapshot");
+            session->enqueue(head, frame);
+            session->waiting_for_snapshot = false;
+        }
+        return;
+    }
+
+    if (!m_keep_history) return;
+
+    auto head = make_head(*frame, event_name(frame->kind));
+    m_history.push_back({frame, head});
+    if (m_history.size() > history_size) {
+        m_history_floor = m_history.front().frame->seq;
+        m_history.pop_front();
+    }
+
+    if (m_sessions.empty()) return;
+    prune();
+
+    for (auto& session : m_sessions) {
+        if (session->waiting_for_snapshot && frame->kind == MessageKind::frame) {
+            // Deltas ohne Ausgangszustand sind nutzlos; ein Voll-Frame ersetzt den Snapshot
+            if (!frame->full_state) continue;
+            session->waiting_for_snapshot = false;
+        }
+        session->enqueue(head, frame);
+    }
+}
+
+void SseHub::tick() {
+    if (m_sessions.empty()) return;
+    prune();
+
+    // Kommentarzeilen halten Proxies und Browser bei Pausen im Spiel bei Laune
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_last_keepalive < std::chrono::seconds(15)) return;
+    m_last_keepalive = now;
+    static const auto keepalive = std::make_shared<const std::string>(": keepalive\n\n");
+    for (auto& session : m_sessions) {
+        session->enqueue(keepalive, nullptr);
+    }
+}
+
+void SseHub::stop() {
+    for (auto& session : m_sessions) {
+        session->close();
+    }
+    m_sessions.clear();
+}
+
+void SseHub::prune() {
+    size_t before = m_sessions.size();
+    m_sessions.erase(std::remove_if(m_sessions.begin(), m_sessions.end(),
+                                    [](const std::shared_ptr<SseSession>& s) { return s->is_closed(); }),
+                     m_sessions.end());
+    if (m_sessions.size() != before) {
+        PLOG_INFO(sse, "Client disconnected. Total SSE clients: %zu", m_sessions.size());
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "encoded_frame.hpp"
+
+#include "ws_config.hpp"
+#include <websocketpp/server.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+class SseSession;
+
+// Server-Sent Events unter GET /events auf dem WebSocket-Port.
+// Die HTTP-Antwort der websocketpp-Verbindung wird zurückgestellt, danach
+// schreiben wir den Stream direkt auf den Socket:
+//   id: <seq>
+//   event: frame | gameplay | config | snapshot
+//   data: <derselbe JSON-Puffer wie beim WebSocket-Broadcast>
+// Mit Last-Event-ID werden verpasste Nachrichten aus einem kurzen Verlauf
+// nachgeliefert; ist die Lücke zu groß, kommt zuerst ein "snapshot".
+// Läuft nur im Server-Thread.
+class SseHub {
+public:
+    using server_t = websocketpp::server<scs_ws::server_config>;
+
+    static constexpr size_t history_size = 600;  // ca. 10 s bei 60 FPS
+
+    SseHub();
+    ~SseHub();
+
+    // Übernimmt eine GET /events-Verbindung. snapshot ist der aktuelle
+    // vollständige Zustand, falls vorhanden (sonst wird auf den nächsten gewartet).
+    void add(server_t::connection_ptr con, EncodedFramePtr snapshot);
+
+    // Verteilt eine Nachricht an alle SSE-Clients
+    void send(const EncodedFramePtr& frame);
+
+    // Keepalive-Kommentare und Aufräumen geschlossener Sitzungen
+    void tick();
+    void stop();
+
+    size_t session_count() const { return m_sessions.size(); }
+
+    // Verlauf auch ohne eigene Clients führen (ein Reconnect kann auf einem anderen Shard landen)
+    void keep_history() { m_keep_history = true; }
+
+private:
+    void prune();
+
+    struct HistoryEntry {
+        EncodedFramePtr frame;
+        std::shared_ptr<const std::string> head; // SSE-Kopfzeilen, von allen Sitzungen geteilt
+    };
+
+    std::vector<std::shared_ptr<SseSession>> m_sessions;
+    std::deque<HistoryEntry> m_history;
+    uint64_t m_history_floor = 0; // seq der zuletzt aus dem Verlauf gefallenen Nachricht
+    bool m_keep_history = false;  // erst ab dem ersten SSE-Client, sonst hält der Verlauf nur Puffer fest
+    std::chrono::steady_clock::time_point m_last_keepalive;
+};
@@ -0,0 +1,277 @@
+#include "stream_sink.hpp"
+#include "plugin_log.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <deque>
+
+namespace asio = websocketpp::lib::asio;
+
+// Basisklasse, damit TCP- und Unix-Socket-Sitzungen in derselben Liste landen
+class StreamSession {
+public:
+    virtual ~StreamSession() = default;
+    virtual void start() = 0;
+    // false, wenn die Nachricht die Puffergrenze überschreiten würde (Nachricht nicht angenommen)
+    virtual bool enqueue(const EncodedFramePtr& frame) = 0;
+    virtual void close() = 0;
+    bool is_closed() const { return m_closed; }
+    size_t buffered() const { return m_buffered; }
+
+protected:
+    bool m_closed = false;
+    size_t m_buffered = 0; // Nutzdaten in der Warteschlange, samt der gerade gesendeten
+};
+
+namespace {
+
+template <typename Protocol>
+class StreamSessionImpl : public StreamSession, public std::enable_shared_from_this<StreamSessionImpl<Protocol>> {
+public:
+    using socket_t = typename Protocol::socket;
+
+    StreamSessionImpl(socket_t socket, bool binary, size_t max_buffered)
+        : m_socket(std::move(socket)), m_binary(binary), m_max_buffered(max_buffered) {}
+
+    void start() override {
+        read_until_closed();
+    }
+
+    // Alles wird in Reihenfolge gepuffert, höchstens m_max_buffered Bytes
+    bool enqueue(const EncodedFramePtr& frame) override {
+        if (m_closed) return true;
+        const size_t size = payload(*frame).size();
+        if (m_max_buffered > 0 && m_buffered + size > m_max_buffered) return false;
+        m_buffered += size;
+        m_queue.push_back(frame);
+        if (!m_writing) write_next();
+        return true;
+    }
+
+    void close() override {
+        if (m_closed) return;
+        m_closed = true;
+        m_queue.clear();
+        m_buffered = 0;
+        asio::error_code ec;
+        m_socket.shutdown(asio::socket_base::shutdown_both, ec);
+        m_socket.close(ec);
+    }
+
+private:
+    // Der Stream ist einseitig; gelesen wird nur, um das Schließen durch den Client zu bemerken
+    void read_until_closed() {
+        auto self = this->shared_from_this();
+        m_socket.async_read_some(asio::buffer(m_read_buf), [self](const asio::error_code& ec, size_t) {
+            if (ec) {
+                self->close();
+                return;
+            }
+            self->read_until_closed();
+        });
+    }
+
+    const FrameBuffer& payload(const EncodedFrame& frame) const {
+        return m_binary ? frame.msgpack : frame.json;
+    }
+
+    void write_next() {
+        if (m_closed || m_queue.empty()) {
+            m_writing = false;
+            return;
+        }
+        m_writing = true;
+        const EncodedFrame& frame = *m_queue.front();
+
+        std::array<asio::const_buffer, 2> buffers;
+        if (m_binary) {
+            const FrameBuffer& data = frame.msgpack;
+            uint32_t len = static_cast<uint32_t>(data.size());
+            for (int i = 0; i < 4; ++i) m_prefix[i] = static_cast<unsigned char>((len >> (8 * i)) & 0xFF);
+            buffers = {asio::buffer(m_prefix, 4), asio::buffer(data.data(), data.size())};
+        } else {
+            static const char newline = '\n';
+            buffers = {asio::buffer(frame.json.data(), frame.json.size()), asio::buffer(&newline, 1)};
+        }
+
+        auto self = this->shared_from_this();
+        asio::async_write(m_socket, buffers, [self](const asio::error_code& ec, size_t) {
+            if (ec) {
+                self->close();
+                return;
+            }
+            if (!self->m_queue.empty()) {
+                self->m_buffered -= self->payload(*self->m_queue.front()).size();
+                self->m_queue.pop_front();
+            }
+            self->write_next();
+        });
+    }
+
+    socket_t m_socket;
+    bool m_binary;
+    size_t m_max_buffered;
+    bool m_writing = false;
+    std::deque<EncodedFramePtr> m_queue;
+    unsigned char m_prefix[4] = {0, 0, 0, 0};
+    std::array<char, 256> m_read_buf{};
+};
+
+} // namespace
+
+StreamSink::StreamSink(io_service_t& io)
+    : m_io(io)
+    , m_tcp_backoff(io)
+#ifdef SCS_WS_HAS_LOCAL_SOCKETS
+    , m_local_backoff(io)
+#endif
+{
+}
+
+StreamSink::~StreamSink() {
+    stop();
+}
+
+bool StreamSink::start(const PluginConfig& cfg) {
+    m_binary = (cfg.stream_format == "binary");
+    m_max_buffered = static_cast<size_t>(std::max(cfg.max_connection_buffer_kb, 0)) * 1024;
+    bool any = false;
+
+    if (cfg.stream_tcp_port > 0) {
+        try {
+            asio::ip::tcp::endpoint ep(asio::ip::address::from_string(cfg.stream_bind), static_cast<unsigned short>(cfg.stream_tcp_port));
+            m_tcp_acceptor.reset(new asio::ip::tcp::acceptor(m_io));
+            m_tcp_acceptor->open(ep.protocol());
+            m_tcp_acceptor->set_option(asio::socket_base::reuse_address(true));
+            m_tcp_acceptor->bind(ep);
+            m_tcp_acceptor->listen();
+            start_tcp_accept();
+            any = true;
+            PLOG_INFO(stream, "TCP stream listening on %s:%d (%s)", cfg.stream_bind.c_str(), cfg.stream_tcp_port, m_binary ? "binary" : "ndjson");
+        } catch (const std::exception& e) {
+            PLOG_ERROR(stream, "TCP listener failed on %s:%d: %s", cfg.stream_bind.c_str(), cfg.stream_tcp_port, e.what());
+            m_tcp_acceptor.reset();
+        }
+    }
+
+    if (!cfg.stream_unix_path.empty()) {
+#ifdef SCS_WS_HAS_LOCAL_SOCKETS
+        try {
+            std::remove(cfg.stream_unix_path.c_str()); // Alte Socket-Datei entfernen
+            m_local_path = cfg.stream_unix_path;
+            m_local_acceptor.reset(new asio::local::stream_protocol::acceptor(m_io, asio::local::stream_protocol::endpoint(m_local_path)));
+            start_local_accept();
+            any = true;
+            PLOG_INFO(stream, "Unix socket stream listening on %s (%s)", m_local_path.c_str(), m_binary ? "binary" : "ndjson");
+        } catch (const std::exception& e) {
+            PLOG_ERROR(stream, "Unix socket listener failed on %s: %s", cfg.stream_unix_path.c_str(), e.what());
+            m_local_acceptor.reset();
+            m_local_path.clear();
+        }
+#else
+        PLOG_WARN(stream, "Unix domain sockets are not supported by this build, ignoring stream_unix_path.");
+#endif
+    }
+    return any;
+}
+
+void StreamSink::stop() {
+    asio::error_code ec;
+    m_tcp_backoff.cancel();
+    if (m_tcp_acceptor) {
+        m_tcp_acceptor->close(ec);
+        m_tcp_acceptor.reset();
+    }
+#ifdef SCS_WS_HAS_LOCAL_SOCKETS
+    m_local_backoff.cancel();
+    if (m_local_acceptor) {
+        m_local_acceptor->close(ec);
+        m_local_acceptor.reset();
+        std::remove(m_local_path.c_str());
+        m_local_path.clear();
+    }
+#endif
+    for (auto& session : m_sessions) {
+        session->close();
+    }
+    m_sessions.clear();
+    if (m_clients_dropped || m_frames_without_msgpack) {
+        PLOG_INFO(stream, "Stopped: %llu clients disconnected for falling behind, %llu frames without MessagePack.",
+                  static_cast<unsigned long long>(m_clients_dropped),
+                  static_cast<unsigned long long>(m_frames_without_msgpack));
+    }
+}
+
+// Nach einem Fehler (z. B. keine freien Deskriptoren) erst nach einer Pause neu annehmen
+void StreamSink::start_tcp_accept() {
+    m_tcp_acceptor->async_accept([this](const asio::error_code& ec, asio::ip::tcp::socket socket) {
+        if (ec == asio::error::operation_aborted || !m_tcp_acceptor) return;
+        if (ec) {
+            m_tcp_backoff.retry([this] { if (m_tcp_acceptor) start_tcp_accept(); });
+            PLOG_WARN(stream, "TCP accept error: %s, retrying in %lld ms", ec.message().c_str(),
+                      static_cast<long long>(m_tcp_backoff.delay().count()));
+            return;
+        }
+        m_tcp_backoff.reset();
+        asio::error_code opt_ec;
+        socket.set_option(asio::ip::tcp::no_delay(true), opt_ec);
+        add_session(std::make_shared<StreamSessionImpl<asio::ip::tcp>>(std::move(socket), m_binary, m_max_buffered));
+        start_tcp_accept();
+    });
+}
+
+#ifdef SCS_WS_HAS_LOCAL_SOCKETS
+void StreamSink::start_local_accept() {
+    m_local_acceptor->async_accept([this](const asio::error_code& ec, asio::local::stream_protocol::socket socket) {
+        if (ec == asio::error::operation_aborted || !m_local_acceptor) return;
+        if (ec) {
+            m_local_backoff.retry([this] { if (m_local_acceptor) start_local_accept(); });
+            PLOG_WARN(stream, "Unix socket accept error: %s, retrying in %lld ms", ec.message().c_str(),
+                      static_cast<long long>(m_local_backoff.delay().count()));
+            return;
+        }
+        m_local_backoff.reset();
+        add_session(std::make_shared<StreamSessionImpl<asio::local::stream_protocol>>(std::move(socket), m_binary, m_max_buffered));
+        start_local_accept();
+    });
+}
+#endif
+
+void StreamSink::add_session(std::shared_ptr<StreamSession> session) {
+    session->start();
+    m_sessions.push_back(std::move(session));
+    PLOG_INFO(stream, "Client connected. Total stream clients: %zu", m_sessions.size());
+}
+
+void StreamSink::send(const EncodedFramePtr& frame) {
+    if (m_sessions.empty()) return;
+
+    // Solange der Binär-Stream läuft, kodiert das Plugin jedes Frame auch als
+    // MessagePack (msgpack_wanted in plugin.cpp). Fehlt es trotzdem, ist das ein
+    // Fehler im Plugin; JSON in einen MessagePack-Stream zu schreiben würde die
+    // Clients nur verwirren.
+    if (m_binary && frame->msgpack.empty()) {
+        if (m_frames_without_msgpack++ == 0) {
+            PLOG_ERROR(stream, "Frame seq %llu (kind %u) has no MessagePack payload, not sent to binary stream clients.",
+                       static_cast<unsigned long long>(frame->seq), static_cast<unsigned>(frame->kind));
+        }
+        return;
+    }
+
+    size_t before = m_sessions.size();
+    m_sessions.erase(std::remove_if(m_sessions.begin(), m_sessions.end(),
+                                    [](const std::shared_ptr<StreamSession>& s) { return s->is_closed(); }),
+                     m_sessions.end());
+    if (m_sessions.size() != before) {
+        PLOG_INFO(stream, "Client disconnected. Total stream clients: %zu", m_sessions.size());
+    }
+
+    for (auto& session : m_sessions) {
+        if (!session->enqueue(frame)) {
+            PLOG_WARN(stream, "Client fell behind (%zu KB waiting), disconnecting.", session->buffered() / 1024);
+            session->close();
+            ++m_clients_dropped;
+        }
+    }
+}
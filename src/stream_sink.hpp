@@ -0,0 +1,64 @@
+#pragma once
+#include "accept_backoff.hpp"
+#include "config.hpp"
+#include "encoded_frame.hpp"
+
+#include <websocketpp/common/asio.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(ASIO_HAS_LOCAL_SOCKETS) || defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+#define SCS_WS_HAS_LOCAL_SOCKETS 1
+#endif
+
+class StreamSession;
+
+// Optionaler Einweg-Stream über rohes TCP und/oder Unix-Domain-Socket.
+// Ohne WebSocket-Handshake und -Framing; Formate:
+//   ndjson: JSON-Text + '\n' pro Nachricht
+//   binary: u32 Länge (little endian) + MessagePack pro Nachricht
+// Läuft auf dem io_service des WebSocket-Servers und verschickt dieselben
+// kodierten Puffer wie der WebSocket-Broadcast. Ein Client, bei dem mehr als
+// max_connection_buffer_kb auf das Senden warten, wird getrennt: Lücken im
+// Stream könnte er nicht erkennen.
+class StreamSink {
+public:
+    using io_service_t = websocketpp::lib::asio::io_service;
+
+    explicit StreamSink(io_service_t& io);
+    ~StreamSink();
+
+    bool start(const PluginConfig& cfg);
+    void stop();
+
+    // Verteilt eine Nachricht an alle Stream-Clients (Server-Thread)
+    void send(const EncodedFramePtr& frame);
+
+    size_t session_count() const { return m_sessions.size(); }
+    uint64_t clients_dropped() const { return m_clients_dropped; }
+    uint64_t frames_without_msgpack() const { return m_frames_without_msgpack; }
+
+private:
+    void start_tcp_accept();
+#ifdef SCS_WS_HAS_LOCAL_SOCKETS
+    void start_local_accept();
+#endif
+    void add_session(std::shared_ptr<StreamSession> session);
+
+    io_service_t& m_io;
+    bool m_binary = false;
+    size_t m_max_buffered = 0; // Bytes pro Client, 0 = unbegrenzt
+    std::unique_ptr<websocketpp::lib::asio::ip::tcp::acceptor> m_tcp_acceptor;
+    AcceptBackoff m_tcp_backoff;
+#ifdef SCS_WS_HAS_LOCAL_SOCKETS
+    std::unique_ptr<websocketpp::lib::asio::local::stream_protocol::acceptor> m_local_acceptor;
+    std::string m_local_path;
+    AcceptBackoff m_local_backoff;
+#endif
+    std::vector<std::shared_ptr<StreamSession>> m_sessions;
+    uint64_t m_clients_dropped = 0;
+    uint64_t m_frames_without_msgpack = 0;
+};
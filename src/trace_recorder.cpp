@@ -0,0 +1,183 @@
+#include "trace_recorder.hpp"
+#include "plugin_log.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+
+std::atomic<bool> g_trace_active{false};
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    int64_t start_ns;
+    int64_t end_ns;
+    uint64_t arg;
+};
+
+} // namespace
+
+// Ringpuffer eines Threads; bei Überlauf gehen die ältesten Spannen verloren
+struct ThreadTrace {
+    static constexpr size_t capacity = 32768;
+
+    std::atomic<uint64_t> head{0};
+    TraceEvent events[capacity];
+};
+
+namespace {
+
+constexpr int max_threads = 32;
+
+// Angemeldete Threads (Platz = tid in der Zeitleiste) und ihre Puffer. Endet ein
+// Thread, wird sein Platz samt Puffer für den nächsten frei (Shard-Threads kommen
+// und gehen mit jedem Serverstart).
+std::atomic<const char*> g_names[max_threads];
+std::atomic<ThreadTrace*> g_threads[max_threads];
+std::atomic<int> g_threads_used{0};        // höchster je belegter Platz + 1
+std::atomic<bool> g_buffers_wanted{false}; // seit dem ersten trace_start bis trace_shutdown
+
+struct SlotHolder {
+    int slot = -1;
+    ~SlotHolder() {
+        if (slot >= 0) g_names[slot].store(nullptr, std::memory_order_release);
+    }
+};
+thread_local SlotHolder t_slot;
+
+enum class State { idle, recording, busy }; // busy: Fenster wird eingerichtet oder geschrieben
+std::atomic<State> g_state{State::idle};
+int64_t g_window_start_ns = 0;
+int64_t g_window_end_ns = 0;
+std::string g_file_path;
+
+// Legt den Puffer eines Platzes an, falls er noch fehlt (trace_start oder Anmeldung
+// können gleichzeitig darauf kommen, nur einer gewinnt)
+void allocate_slot(int slot) {
+    if (g_threads[slot].load(std::memory_order_acquire)) return;
+    ThreadTrace* fresh = new ThreadTrace();
+    ThreadTrace* expected = nullptr;
+    if (!g_threads[slot].compare_exchange_strong(expected, fresh, std::memory_order_acq_rel)) delete fresh;
+}
+
+void write_escaped(FILE* f, const char* text) {
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') std::fputc('\\', f);
+        std::fputc(*c, f);
+    }
+}
+
+// Trace Event Format: "X" = vollständige Spanne, "M" = Metadaten (Thread-Namen), Zeiten in µs
+bool write_file(const std::string& path, int64_t from_ns, int64_t to_ns, size_t& written) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", f);
+    bool first = true;
+    int used = std::min(g_threads_used.load(std::memory_order_relaxed), max_threads);
+    for (int i = 0; i < used; ++i) {
+        ThreadTrace* trace = g_threads[i].load(std::memory_order_acquire);
+        if (!trace) continue;
+        std::fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"", first ? "" : ",\n", i);
+        if (const char* name = g_names[i].load(std::memory_order_relaxed)) {
+            write_escaped(f, name);
+        } else {
+            std::fprintf(f, "thread %d", i); // inzwischen beendet
+        }
+        std::fputs("\"}}", f);
+        first = false;
+
+        uint64_t head = trace->head.load(std::memory_order_acquire);
+        uint64_t begin = head > ThreadTrace::capacity ? head - ThreadTrace::capacity : 0;
+        for (uint64_t n = begin; n < head; ++n) {
+            const TraceEvent& e = trace->events[n % ThreadTrace::capacity];
+            if (e.start_ns < from_ns || e.start_ns > to_ns) continue;
+            std::fputs(",\n{\"name\":\"", f);
+            write_escaped(f, e.name);
+            std::fprintf(f, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f", i,
+                         (e.start_ns - from_ns) / 1000.0, (e.end_ns - e.start_ns) / 1000.0);
+            if (e.arg != 0) std::fprintf(f, ",\"args\":{\"n\":%" PRIu64 "}", e.arg);
+            std::fputc('}', f);
+            ++written;
+        }
+    }
+    std::fputs("\n]}\n", f);
+    return std::fclose(f) == 0;
+}
+
+} // namespace
+
+void trace_name_thread(const char* name) {
+    int& slot = t_slot.slot;
+    if (slot >= 0) {
+        g_names[slot].store(name, std::memory_order_relaxed);
+        return;
+    }
+    for (int i = 0; i < max_threads && slot < 0; ++i) {
+        const char* expected = nullptr;
+        if (g_names[i].compare_exchange_strong(expected, name, std::memory_order_acq_rel)) slot = i;
+    }
+    if (slot < 0) return;
+    int used = g_threads_used.load(std::memory_order_relaxed);
+    while (used <= slot && !g_threads_used.compare_exchange_weak(used, slot + 1, std::memory_order_relaxed)) {
+    }
+    if (g_buffers_wanted.load(std::memory_order_acquire)) allocate_slot(slot);
+}
+
+ThreadTrace* trace_thread_buffer() {
+    return t_slot.slot < 0 ? nullptr : g_threads[t_slot.slot].load(std::memory_order_acquire);
+}
+
+void trace_record(ThreadTrace* trace, const char* name, int64_t start_ns, int64_t end_ns, uint64_t arg) {
+    uint64_t head = trace->head.load(std::memory_order_relaxed);
+    trace->events[head % ThreadTrace::capacity] = {name, start_ns, end_ns, arg};
+    trace->head.store(head + 1, std::memory_order_release);
+}
+
+void trace_span(const char* name, int64_t start_ns, int64_t end_ns, uint64_t arg) {
+    ThreadTrace* trace = trace_thread_buffer();
+    if (trace) trace_record(trace, name, start_ns, end_ns, arg);
+}
+
+bool trace_start(uint32_t duration_ms, const std::string& file_path) {
+    State expected = State::idle;
+    if (duration_ms == 0 || !g_state.compare_exchange_strong(expected, State::busy)) return false;
+    // Puffer vor dem Fenster anlegen, damit kein Messpunkt allokiert
+    g_buffers_wanted.store(true, std::memory_order_release);
+    int used = std::min(g_threads_used.load(std::memory_order_relaxed), max_threads);
+    for (int i = 0; i < used; ++i) {
+        if (g_names[i].load(std::memory_order_relaxed)) allocate_slot(i);
+    }
+    g_file_path = file_path;
+    g_window_start_ns = trace_now_ns();
+    g_window_end_ns = g_window_start_ns + static_cast<int64_t>(duration_ms) * 1000000;
+    g_state.store(State::recording, std::memory_order_release);
+    g_trace_active.store(true, std::memory_order_relaxed);
+    PLOG_INFO(plugin, "Tracing for %u ms into %s", duration_ms, file_path.c_str());
+    return true;
+}
+
+void trace_poll() {
+    if (g_state.load(std::memory_order_acquire) != State::recording) return;
+    int64_t now = trace_now_ns();
+    // Nach dem Fenster noch 50 ms warten, damit laufende Spannen abgeschlossen sind
+    if (now >= g_window_end_ns) g_trace_active.store(false, std::memory_order_relaxed);
+    if (now < g_window_end_ns + 50000000) return;
+
+    g_state.store(State::busy, std::memory_order_relaxed);
+    size_t written = 0;
+    if (write_file(g_file_path, g_window_start_ns, g_window_end_ns, written)) {
+        PLOG_INFO(plugin, "Trace written: %zu spans in %s", written, g_file_path.c_str());
+    } else {
+        PLOG_WARN(plugin, "Could not write trace to %s", g_file_path.c_str());
+    }
+    g_state.store(State::idle, std::memory_order_release);
+}
+
+void trace_shutdown() {
+    g_trace_active.store(false, std::memory_order_relaxed);
+    g_buffers_wanted.store(false, std::memory_order_release);
+    g_state.store(State::idle, std::memory_order_release);
+    for (auto& slot : g_threads) delete slot.exchange(nullptr, std::memory_order_acq_rel);
+}
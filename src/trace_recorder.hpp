@@ -0,0 +1,80 @@
+#pragma once
+// Zeitleiste der Pipeline als Chrome/Perfetto-Trace (trace.json, "Trace Event Format").
+// Jeder Thread schreibt Spannen in seinen eigenen Ringpuffer (ein Schreiber, keine
+// Sperre); nach Ablauf des Zeitfensters schreibt der Server-Thread die Datei.
+//
+//   void TelemetryPlugin::on_frame_end() {
+//       TRACE_SCOPE("frame_end");
+//
+// Ohne laufende Aufzeichnung kostet ein Messpunkt nur das Lesen von g_trace_active
+// und im Destruktor die Prüfung des im Konstruktor gemerkten Puffers. Die Puffer
+// (ca. 1 MB je Thread) entstehen bei trace_start für alle angemeldeten Threads,
+// nie während einer Spanne; freigegeben werden sie mit trace_shutdown.
+// Namen müssen String-Literale sein (gespeichert wird nur der Zeiger).
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+extern std::atomic<bool> g_trace_active;
+
+inline bool trace_active() {
+    return g_trace_active.load(std::memory_order_relaxed);
+}
+
+inline int64_t trace_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct ThreadTrace;
+
+// Meldet den aufrufenden Thread unter diesem Namen an; nur angemeldete Threads
+// zeichnen auf. Nach dem ersten trace_start bekommt er seinen Puffer sofort.
+void trace_name_thread(const char* name);
+
+// Puffer des aufrufenden Threads, nullptr wenn nicht angemeldet oder keiner angelegt
+ThreadTrace* trace_thread_buffer();
+
+// Eine abgeschlossene Spanne (start/end aus trace_now_ns), arg erscheint als args.n
+void trace_record(ThreadTrace* trace, const char* name, int64_t start_ns, int64_t end_ns, uint64_t arg);
+void trace_span(const char* name, int64_t start_ns, int64_t end_ns, uint64_t arg = 0);
+
+// Startet ein Zeitfenster; false, wenn schon eines läuft oder geschrieben wird
+bool trace_start(uint32_t duration_ms, const std::string& file_path);
+
+// Nur Server-Thread, regelmäßig: beendet das Fenster und schreibt die Datei
+void trace_poll();
+
+// Beim Beenden, wenn kein aufzeichnender Thread mehr läuft: gibt alle Puffer frei
+void trace_shutdown();
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : m_name(name) {
+        if (trace_active()) {
+            m_trace = trace_thread_buffer();
+            m_start = trace_now_ns();
+        }
+    }
+    ~TraceScope() {
+        if (m_trace) trace_record(m_trace, m_name, m_start, trace_now_ns(), m_arg);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    void set_arg(uint64_t arg) { m_arg = arg; }
+    // Spanne doch nicht aufzeichnen (z.B. wenn es nichts zu tun gab)
+    void dismiss() { m_trace = nullptr; }
+
+private:
+    const char* m_name;
+    ThreadTrace* m_trace = nullptr;
+    int64_t m_start = 0;
+    uint64_t m_arg = 0;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
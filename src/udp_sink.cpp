@@ -0,0 +1,118 @@
+#include "udp_sink.hpp"
+#include "plugin_log.hpp"
+
+#include <array>
+#include <string>
+
+namespace asio = websocketpp::lib::asio;
+
+UdpSink::UdpSink(io_service_t& io) : m_io(io) {}
+
+// Zerlegt "host:port" bzw. "[v6-host]:port"
+static bool split_host_port(const std::string& target, std::string& host, std::string& port) {
+    size_t colon = target.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 >= target.size()) return false;
+    host = target.substr(0, colon);
+    port = target.substr(colon + 1);
+    if (host.size() > 2 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);
+    }
+    return true;
+}
+
+bool UdpSink::open_socket_for(const udp::endpoint& ep) {
+    auto& sock = ep.address().is_v6() ? m_socket_v6 : m_socket_v4;
+    if (!sock) {
+        sock.reset(new udp::socket(m_io));
+        sock->open(ep.protocol());
+        // Niemals im Server-Thread blockieren: volle Sendepuffer führen zum Verwerfen
+        sock->non_blocking(true);
+    }
+    if (ep.address().is_multicast()) {
+        sock->set_option(asio::ip::multicast::hops(m_multicast_ttl));
+    }
+    return true;
+}
+
+bool UdpSink::start(const PluginConfig& cfg) {
+    m_use_msgpack = (cfg.udp_format == "msgpack");
+    m_multicast_ttl = cfg.udp_multicast_ttl;
+    m_targets.clear();
+
+    udp::resolver resolver(m_io);
+    for (const auto& target : cfg.udp_targets) {
+        std::string host, port;
+        if (!split_host_port(target, host, port)) {
+            PLOG_WARN(udp, "Invalid target '%s' (expected host:port)", target.c_str());
+            continue;
+        }
+        try {
+            auto results = resolver.resolve(host, port);
+            if (results.begin() == results.end()) {
+                PLOG_WARN(udp, "Could not resolve target '%s'", target.c_str());
+                continue;
+            }
+            udp::endpoint ep = *results.begin();
+            open_socket_for(ep);
+            m_targets.push_back(ep);
+            PLOG_INFO(udp, "Target added: %s:%u%s", ep.address().to_string().c_str(), ep.port(),
+                      ep.address().is_multicast() ? " (multicast)" : "");
+        } catch (const std::exception& e) {
+            PLOG_WARN(udp, "Failed to set up target '%s': %s", target.c_str(), e.what());
+        }
+    }
+
+    if (m_targets.empty()) {
+        PLOG_WARN(udp, "No usable targets, UDP output disabled.");
+        stop();
+        return false;
+    }
+    PLOG_INFO(udp, "Output started with %zu target(s), format=%s", m_targets.size(), m_use_msgpack ? "msgpack" : "json");
+    return true;
+}
+
+void UdpSink::stop() {
+    asio::error_code ec;
+    if (m_socket_v4) m_socket_v4->close(ec);
+    if (m_socket_v6) m_socket_v6->close(ec);
+    m_socket_v4.reset();
+    m_socket_v6.reset();
+    m_targets.clear();
+}
+
+void UdpSink::send(const EncodedFrame& frame) {
+    if (m_targets.empty()) return;
+
+    const FrameBuffer& payload = m_use_msgpack ? frame.msgpack : frame.json;
+    if (payload.empty() || payload.size() > max_payload_size) {
+        m_datagrams_dropped.fetch_add(m_targets.size(), std::memory_order_relaxed);
+        return;
+    }
+
+    std::array<unsigned char, header_size> header{};
+    header[0] = 'S'; header[1] = 'C'; header[2] = 'S'; header[3] = 'U';
+    header[4] = 1;
+    header[5] = m_use_msgpack ? 1 : 0;
+    header[6] = static_cast<unsigned char>(frame.kind);
+    for (int i = 0; i < 8; ++i) {
+        header[8 + i] = static_cast<unsigned char>((frame.seq >> (8 * i)) & 0xFF);
+    }
+
+    // Scatter/Gather: Header und geteilter Nutzdaten-Puffer ohne Zusammenkopieren
+    std::array<asio::const_buffer, 2> buffers = {
+        asio::buffer(header),
+        asio::buffer(payload.data(), payload.size())
+    };
+
+    for (const auto& ep : m_targets) {
+        auto& sock = ep.address().is_v6() ? m_socket_v6 : m_socket_v4;
+        if (!sock) continue;
+        asio::error_code ec;
+        sock->send_to(buffers, ep, 0, ec);
+        if (ec) {
+            m_datagrams_dropped.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            m_datagrams_sent.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
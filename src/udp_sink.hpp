@@ -0,0 +1,56 @@
+#pragma once
+#include "config.hpp"
+#include "encoded_frame.hpp"
+
+#include <websocketpp/common/asio.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Optionaler UDP-Ausgang: jedes Frame wird als einzelnes Datagramm an alle
+// konfigurierten Ziele (Unicast oder Multicast) geschickt. Keine Wiederholung,
+// keine Bestätigung - was verloren geht, ist verloren.
+//
+// Datagramm-Aufbau (little endian):
+//   0  u8[4] magic "SCSU"
+//   4  u8    Version (1)
+//   5  u8    Format (0 = JSON, 1 = MessagePack)
+//   6  u8    MessageKind
+//   7  u8    reserviert
+//   8  u64   Sequenznummer
+//  16  ...   Nutzdaten (derselbe Puffer wie beim WebSocket-Broadcast)
+class UdpSink {
+public:
+    using io_service_t = websocketpp::lib::asio::io_service;
+    using udp = websocketpp::lib::asio::ip::udp;
+
+    static constexpr size_t header_size = 16;
+    static constexpr size_t max_payload_size = 65507 - header_size;
+
+    explicit UdpSink(io_service_t& io);
+
+    // Löst die Ziele auf und öffnet die Sockets. Nur vom Server-Thread vor dem Start aufrufen.
+    bool start(const PluginConfig& cfg);
+    void stop();
+
+    // Sendet ein Frame an alle Ziele (nicht blockierend, läuft im Server-Thread)
+    void send(const EncodedFrame& frame);
+
+    uint64_t datagrams_sent() const { return m_datagrams_sent.load(std::memory_order_relaxed); }
+    uint64_t datagrams_dropped() const { return m_datagrams_dropped.load(std::memory_order_relaxed); }
+
+private:
+    bool open_socket_for(const udp::endpoint& ep);
+
+    io_service_t& m_io;
+    std::unique_ptr<udp::socket> m_socket_v4;
+    std::unique_ptr<udp::socket> m_socket_v6;
+    std::vector<udp::endpoint> m_targets;
+    bool m_use_msgpack = false;
+    int m_multicast_ttl = 1;
+
+    std::atomic<uint64_t> m_datagrams_sent{0};
+    std::atomic<uint64_t> m_datagrams_dropped{0};
+};
@@ -0,0 +1,151 @@
+#include "usage_stats.hpp"
+#include "frame_timing.hpp"
+#include "plugin_log.hpp"
+
+#include <algorithm>
+
+#include <nlohmann/json.hpp>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+MemoryCounter g_memory[static_cast<size_t>(MemoryUse::count)];
+std::atomic<uint64_t> g_game_callback_ns{0};
+
+namespace {
+
+constexpr size_t thread_kinds = static_cast<size_t>(UsageThread::count);
+constexpr size_t memory_uses = static_cast<size_t>(MemoryUse::count);
+
+// Ein Platz pro Thread; beendete Threads behalten ihren letzten Wert
+struct ThreadSlot {
+    std::atomic<uint8_t> kind{0};
+    std::atomic<uint64_t> cpu_ns{0};
+};
+
+constexpr int max_threads = 32;
+ThreadSlot g_slots[max_threads];
+std::atomic<int> g_slots_used{0};
+thread_local int t_slot = -1;
+
+std::atomic<int64_t> g_peak_buffered{0};
+const std::chrono::steady_clock::time_point g_started = std::chrono::steady_clock::now();
+
+const char* const thread_names[thread_kinds] = {"game", "server", "shards", "log_writer"};
+const char* const memory_names[memory_uses] = {"frames", "state", "queues"};
+
+uint64_t current_thread_cpu_ns() {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) return 0;
+    auto ticks = [](const FILETIME& t) { return (static_cast<uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime; };
+    return (ticks(kernel) + ticks(user)) * 100; // 100-ns-Einheiten
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+#endif
+}
+
+uint64_t thread_cpu_ns(UsageThread kind) {
+    if (kind == UsageThread::game) return g_game_callback_ns.load(std::memory_order_relaxed);
+    uint64_t total = 0;
+    int used = std::min(g_slots_used.load(std::memory_order_relaxed), max_threads);
+    for (int i = 0; i < used; ++i) {
+        if (g_slots[i].kind.load(std::memory_order_relaxed) == static_cast<uint8_t>(kind)) {
+            total += g_slots[i].cpu_ns.load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+double uptime_s() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - g_started).count();
+}
+
+} // namespace
+
+void memory_note_peak(MemoryCounter& counter, int64_t current) {
+    int64_t peak = counter.peak.load(std::memory_order_relaxed);
+    while (current > peak && !counter.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+    }
+}
+
+void usage_sample_thread(UsageThread kind) {
+    if (t_slot < 0) {
+        int slot = g_slots_used.fetch_add(1, std::memory_order_relaxed);
+        if (slot >= max_threads) {
+            g_slots_used.store(max_threads, std::memory_order_relaxed);
+            return;
+        }
+        t_slot = slot;
+        g_slots[slot].kind.store(static_cast<uint8_t>(kind), std::memory_order_relaxed);
+    }
+    g_slots[t_slot].cpu_ns.store(current_thread_cpu_ns(), std::memory_order_relaxed);
+}
+
+void usage_note_buffered(int64_t bytes) {
+    int64_t peak = g_peak_buffered.load(std::memory_order_relaxed);
+    while (bytes > peak && !g_peak_buffered.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {
+    }
+}
+
+std::string usage_message() {
+    const double uptime = uptime_s();
+    nlohmann::json cpu = nlohmann::json::object();
+    for (size_t i = 0; i < thread_kinds; ++i) {
+        double ms = thread_cpu_ns(static_cast<UsageThread>(i)) / 1e6;
+        cpu[thread_names[i]] = {{"ms", ms}, {"percent", uptime > 0 ? ms / 10.0 / uptime : 0.0}};
+    }
+    nlohmann::json memory = nlohmann::json::object();
+    for (size_t i = 0; i < memory_uses; ++i) {
+        memory[memory_names[i]] = {{"bytes", g_memory[i].current.load(std::memory_order_relaxed)},
+                                   {"peak_bytes", g_memory[i].peak.load(std::memory_order_relaxed)},
+                                   {"allocations", g_memory[i].allocations.load(std::memory_order_relaxed)}};
+    }
+    const FrameTimingStats& t = g_frame_timing;
+    nlohmann::json game = {{"fps", t.fps.load(std::memory_order_relaxed)},
+                           {"frame_interval_ms", {{"mean", t.frame_interval_ms.load(std::memory_order_relaxed)},
+                                                  {"max", t.frame_interval_max_ms.load(std::memory_order_relaxed)}}},
+                           {"simulation_step_ms", t.simulation_step_ms.load(std::memory_order_relaxed)},
+                           {"simulation_jitter_ms", t.simulation_jitter_ms.load(std::memory_order_relaxed)},
+                           {"plugin_ms_per_frame", t.plugin_ms_per_frame.load(std::memory_order_relaxed)},
+                           {"plugin_frame_ratio", t.plugin_frame_ratio.load(std::memory_order_relaxed)},
+                           {"frames", t.frames.load(std::memory_order_relaxed)},
+                           {"paused", t.paused.load(std::memory_order_relaxed)},
+                           {"pauses", t.pauses.load(std::memory_order_relaxed)},
+                           {"paused_s", t.paused_s.load(std::memory_order_relaxed)},
+                           {"last_pause_s", t.last_pause_s.load(std::memory_order_relaxed)}};
+    nlohmann::json message = {{"type", "usage"},
+                              {"uptime_s", uptime},
+                              {"cpu", cpu},
+                              {"memory", memory},
+                              {"peak_buffered_bytes", g_peak_buffered.load(std::memory_order_relaxed)},
+                              {"game", game}};
+    return message.dump();
+}
+
+void usage_log_summary() {
+    const double uptime = uptime_s();
+    for (size_t i = 0; i < thread_kinds; ++i) {
+        double ms = thread_cpu_ns(static_cast<UsageThread>(i)) / 1e6;
+        PLOG_INFO(plugin, "CPU %-10s %.1f ms (%.3f %% of %.0f s)", thread_names[i], ms, uptime > 0 ? ms / 10.0 / uptime : 0.0, uptime);
+    }
+    for (size_t i = 0; i < memory_uses; ++i) {
+        PLOG_INFO(plugin, "Memory %-7s %lld bytes now, peak %lld bytes, %llu allocations", memory_names[i],
+                  static_cast<long long>(g_memory[i].current.load(std::memory_order_relaxed)),
+                  static_cast<long long>(g_memory[i].peak.load(std::memory_order_relaxed)),
+                  static_cast<unsigned long long>(g_memory[i].allocations.load(std::memory_order_relaxed)));
+    }
+    PLOG_INFO(plugin, "Peak buffered outgoing data: %lld bytes", static_cast<long long>(g_peak_buffered.load(std::memory_order_relaxed)));
+    PLOG_INFO(plugin, "Game: %llu frames, last %.1f FPS, %llu pauses (%.0f s), plugin %.3f ms per frame (%.2f %%)",
+              static_cast<unsigned long long>(g_frame_timing.frames.load(std::memory_order_relaxed)),
+              g_frame_timing.fps.load(std::memory_order_relaxed),
+              static_cast<unsigned long long>(g_frame_timing.pauses.load(std::memory_order_relaxed)),
+              g_frame_timing.paused_s.load(std::memory_order_relaxed),
+              g_frame_timing.plugin_ms_per_frame.load(std::memory_order_relaxed),
+              g_frame_timing.plugin_frame_ratio.load(std::memory_order_relaxed) * 100.0);
+}
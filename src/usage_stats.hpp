@@ -0,0 +1,44 @@
+#pragma once
+// Was das Plugin selbst verbraucht: CPU-Zeit seiner Threads (im Spiel-Thread nur die
+// Zeit innerhalb der SDK-Callbacks), Heap-Speicher der eigenen Container und
+// Nachrichtenpuffer (über CountingAllocator) und den Höchststand der Sendepuffer.
+// Alle Zähler sind relaxed atomics; gelesen wird für {"type":"usage"} und beim Beenden.
+
+#include "counting_allocator.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+enum class UsageThread : uint8_t { game, server, shard, log_writer, count };
+
+// Aus der Schleife eines Plugin-Threads aufrufen: trägt dessen bisherige CPU-Zeit ein
+void usage_sample_thread(UsageThread kind);
+
+// Spiel-Thread: Zeit innerhalb eines SDK-Callbacks (Wanduhr, der Thread gehört sonst dem Spiel)
+extern std::atomic<uint64_t> g_game_callback_ns;
+
+class GameCallbackTimer {
+public:
+    GameCallbackTimer() : m_start(std::chrono::steady_clock::now()) {}
+    ~GameCallbackTimer() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+        g_game_callback_ns.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+    }
+
+    GameCallbackTimer(const GameCallbackTimer&) = delete;
+    GameCallbackTimer& operator=(const GameCallbackTimer&) = delete;
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// Server: wartende Sendedaten aller Verbindungen, für den Höchststand
+void usage_note_buffered(int64_t bytes);
+
+// {"type":"usage","uptime_s":..,"cpu":{...},"memory":{...},"peak_buffered_bytes":..} als JSON-Text
+std::string usage_message();
+
+// Zusammenfassung ins Log (beim Beenden)
+void usage_log_summary();
@@ -1,38 +1,106 @@
 #include "websocket_server.hpp"
 #include "plugin_log.hpp"
+#include "trace_recorder.hpp"
+#include "usage_stats.hpp"
 #include <iostream>
 #include <chrono>
+#include <algorithm>
 
 WebSocketServer::WebSocketServer() : m_running(false) {
-    m_server.set_open_handler([this](connection_hdl hdl) { this->on_open(hdl); });
-    m_server.set_close_handler([this](connection_hdl hdl) { this->on_close(hdl); });
-    m_server.set_message_handler([this](connection_hdl hdl, server_t::message_ptr msg) { this->on_message(hdl, msg); });
-
-    m_server.clear_access_channels(websocketpp::log::alevel::all);
-    m_server.clear_error_channels(websocketpp::log::elevel::all);
 }
 
 WebSocketServer::~WebSocketServer() {
     stop();
 }
 
-bool WebSocketServer::start(unsigned short port) {
+bool WebSocketServer::start(const PluginConfig& cfg) {
     if (m_running.load()) return true;
 
     try {
-        m_server.init_asio();
-        m_server.set_reuse_addr(true);
-        m_server.listen(port);
-        m_server.start_accept();
+        m_acceptor.reset();
+        m_accept_backoff.reset();
+        m_message_queue.reset(new FrameQueue(static_cast<size_t>(std::max(cfg.queue_capacity, 16)),
+                                             cfg.queue_overflow == "drop_newest" ? FrameQueue::Overflow::drop_newest
+                                                                                 : FrameQueue::Overflow::drop_oldest));
+        m_udp_sink.reset();
+        m_stream_sink.reset();
+        m_shm_sink.reset();
+        const size_t shard_count = static_cast<size_t>(std::min(std::max(cfg.ws_threads, 1), 16));
+        m_shards.clear();
+        for (size_t i = 0; i < shard_count; ++i) {
+            m_shards.emplace_back(new WsShard(i, m_shared));
+        }
+        m_next_shard = 0;
+        m_shared.registries.clear();
+        for (const auto& shard : m_shards) {
+            m_shared.registries.push_back(&shard->connections());
+        }
+        m_shared.queue = m_message_queue.get();
+        m_shared.metrics_enabled = cfg.metrics_enabled;
+        m_shared.clients_enabled = cfg.clients_enabled;
+        m_shared.trace_enabled = cfg.trace_enabled;
+        m_shared.trace_file = cfg.trace_file;
+        m_shared.ping_interval = std::chrono::milliseconds(std::max(cfg.ping_interval_ms, 0));
+        m_shared.max_clients = std::max(cfg.max_connections, 0);
+        m_shared.max_connection_buffer = static_cast<size_t>(std::max(cfg.max_connection_buffer_kb, 0)) * 1024;
+        m_shared.max_total_buffer = static_cast<size_t>(std::max(cfg.max_total_buffer_kb, 0)) * 1024;
+        m_shared.disconnect_on_limit = cfg.buffer_limit_policy == "disconnect";
+        m_shared.journal.open(static_cast<size_t>(std::max(cfg.journal_size, 0)), cfg.journal_file);
+        m_usage_interval = std::chrono::seconds(std::max(cfg.usage_interval_s, 0));
+        m_next_usage = std::chrono::steady_clock::now() + m_usage_interval;
+
+        // Eigener Listener statt endpoint::listen, damit angenommene Sockets im
+        // Thread ihres Shards zu websocketpp-Verbindungen werden (siehe accept_next)
+        WsShard::server_t& primary = m_shards.front()->server();
+        namespace asio = websocketpp::lib::asio;
+        asio::ip::tcp::endpoint listen_ep(asio::ip::tcp::v6(), static_cast<unsigned short>(cfg.port));
+        m_acceptor.reset(new asio::ip::tcp::acceptor(primary.get_io_service()));
+        m_acceptor->open(listen_ep.protocol());
+        m_acceptor->set_option(asio::socket_base::reuse_address(true));
+        m_acceptor->bind(listen_ep);
+        m_acceptor->listen(asio::socket_base::max_connections);
+        m_accept_backoff.reset(new AcceptBackoff(primary.get_io_service()));
+        accept_next();
+
+        if (cfg.udp_enabled) {
+            m_udp_sink.reset(new UdpSink(primary.get_io_service()));
+            if (!m_udp_sink->start(cfg)) {
+                m_udp_sink.reset();
+            }
+        }
+        if (cfg.stream_tcp_port > 0 || !cfg.stream_unix_path.empty()) {
+            m_stream_sink.reset(new StreamSink(primary.get_io_service()));
+            if (!m_stream_sink->start(cfg)) {
+                m_stream_sink.reset();
+            }
+        }
+        if (cfg.shm_enabled) {
+            m_shm_sink.reset(new ShmRingSink());
+            if (!m_shm_sink->start(cfg)) {
+                m_shm_sink.reset();
+            }
+        }
 
+        for (size_t i = 1; i < shard_count; ++i) {
+            m_shards[i]->start_thread(cfg);
+        }
         m_running.store(true);
         m_thread = std::thread(&WebSocketServer::run_server, this);
 
-        plugin_log_printf("[WS] Server start requested, thread launched.");
+        PLOG_INFO(ws, "Server start requested, thread launched (%zu io threads).", shard_count);
         return true;
     } catch (const std::exception& e) {
-        plugin_log_printf("[WS] start() exception: %s", e.what());
+        PLOG_ERROR(ws, "start() exception: %s", e.what());
         m_running.store(false);
+        // Listener, Pause und Ausgänge hängen am io_service von Shard 0, also vor den Shards abbauen
+        m_accept_backoff.reset();
+        m_acceptor.reset();
+        m_udp_sink.reset();
+        m_stream_sink.reset();
+        m_shm_sink.reset();
+        m_shared.journal.close();
+        m_shared.registries.clear();
+        m_shards.clear();
         return false;
     }
 }
@@ -41,94 +109,154 @@ void WebSocketServer::stop() {
     if (!m_running.exchange(false)) {
         return; // Bereits gestoppt
     }
-    plugin_log_printf("[WS] Stopping server...");
-
-    try {
-        m_server.stop_listening();
-
-        // Alle Verbindungen schließen
-        std::lock_guard<std::mutex> lock(m_connection_mutex);
-        for (auto const& hdl : m_connections) {
-            m_server.close(hdl, websocketpp::close::status::going_away, "Server shutdown");
-        }
-    } catch (const std::exception& e) {
-        plugin_log_printf("[WS] Exception while closing connections: %s", e.what());
-    }
+    PLOG_INFO(ws, "Stopping server...");
 
+    // Listener und Verbindungen schließt der Server-Thread selbst (siehe run_server),
+    // websocketpp läuft ohne Sperren
     if (m_thread.joinable()) {
         m_thread.join();
     }
-    plugin_log_printf("[WS] Server stopped.");
+    PLOG_INFO(ws, "Server stopped.");
 }
 
 bool WebSocketServer::is_running() const {
     return m_running.load();
 }
 
-void WebSocketServer::queue_broadcast(const std::string& msg) {
-    std::lock_guard<std::mutex> lock(m_queue_mutex);
-    m_message_queue.push_back(msg);
+bool WebSocketServer::snapshot_wanted() const {
+    int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    return now < m_shared.snapshot_wanted_until.load(std::memory_order_relaxed);
+}
+
+void WebSocketServer::queue_broadcast(EncodedFramePtr frame) {
+    if (!frame || !m_message_queue) return;
+    m_message_queue->push(std::move(frame));
+}
+
+// Verteilt neue Verbindungen reihum auf die Shards. Angenommen wird im
+// Server-Thread über den einen Listener; der Socket wird auf dem io_service des
+// Ziel-Shards angelegt (das erlaubt asio von jedem Thread aus), websocketpp
+// selbst fasst nur der Thread des Shards an (WsShard::adopt). Schlägt accept
+// fehl, etwa mit EMFILE, wird erst nach einer Pause neu gewartet.
+void WebSocketServer::accept_next() {
+    namespace asio = websocketpp::lib::asio;
+    if (!m_acceptor || !m_acceptor->is_open()) return;
+
+    WsShard& target = *m_shards[m_next_shard];
+    auto socket = std::make_shared<asio::ip::tcp::socket>(target.server().get_io_service());
+    m_acceptor->async_accept(*socket, [this, &target, socket](const asio::error_code& ec) {
+        if (ec == asio::error::operation_aborted || !m_acceptor) return;
+        if (ec) {
+            m_accept_backoff->retry([this] { accept_next(); });
+            PLOG_WARN(ws, "Accept failed: %s, retrying in %lld ms", ec.message().c_str(),
+                      static_cast<long long>(m_accept_backoff->delay().count()));
+            return;
+        }
+        m_accept_backoff->reset();
+        m_next_shard = (m_next_shard + 1) % m_shards.size();
+        target.adopt(std::move(*socket));
+        accept_next();
+    });
 }
 
 void WebSocketServer::run_server() {
-    plugin_log_printf("[WS Thread] Server thread started.");
+    PLOG_DEBUG(ws, "Server thread started.");
+    trace_name_thread("server");
+    WsShard& primary = *m_shards.front();
     while (m_running.load()) {
         try {
             // Abarbeitung der Server-Events (non-blocking)
-            m_server.poll();
+            primary.server().poll();
 
             // Nachrichten aus der Queue verarbeiten
             process_message_queue();
-            
+
+            // Zurückgestellte HTTP-Anfragen beantworten, SSE-Keepalive
+            primary.service();
+
+            // Abgelaufenes Trace-Fenster in die Datei schreiben
+            trace_poll();
+
+            // Ressourcenverbrauch messen und in festem Abstand an die Clients schicken
+            usage_sample_thread(UsageThread::server);
+            if (m_usage_interval.count() > 0 && std::chrono::steady_clock::now() >= m_next_usage) {
+                m_next_usage = std::chrono::steady_clock::now() + m_usage_interval;
+                broadcast_usage();
+            }
+
             // Kurze Pause, um CPU-Last zu vermeiden
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
         } catch (const std::exception& e) {
-            plugin_log_printf("[WS Thread] Exception in run_server loop: %s", e.what());
+            PLOG_ERROR(ws, "Exception in run_server loop: %s", e.what());
         }
     }
-     m_server.stop(); // Stoppt den poll-Vorgang
-    plugin_log_printf("[WS Thread] Server thread finished.");
-}
 
-void WebSocketServer::process_message_queue() {
-    std::vector<std::string> messages_to_send;
-    {
-        std::lock_guard<std::mutex> lock(m_queue_mutex);
-        if (m_message_queue.empty()) {
-            return;
-        }
-        messages_to_send.swap(m_message_queue);
+    websocketpp::lib::asio::error_code ec;
+    m_accept_backoff->cancel();
+    m_acceptor->close(ec);
+    for (size_t i = 1; i < m_shards.size(); ++i) {
+        m_shards[i]->stop_thread();
     }
+    if (m_udp_sink) {
+        PLOG_INFO(udp, "Stopping output: %llu datagrams sent, %llu dropped.",
+                  static_cast<unsigned long long>(m_udp_sink->datagrams_sent()),
+                  static_cast<unsigned long long>(m_udp_sink->datagrams_dropped()));
+        m_udp_sink->stop();
+    }
+    if (m_shm_sink) {
+        m_shm_sink->stop();
+    }
+    PLOG_INFO(ws, "Queue: capacity %zu, high water %zu, %llu frames dropped, %llu events overflowed.",
+              m_message_queue->capacity(), m_message_queue->high_water(),
+              static_cast<unsigned long long>(m_message_queue->frames_dropped()),
+              static_cast<unsigned long long>(m_message_queue->events_overflowed()));
+    if (m_stream_sink) {
+        m_stream_sink->stop();
+    }
+    primary.shutdown();
+    m_shared.journal.close();
+    PLOG_DEBUG(ws, "Server thread finished.");
+}
 
-    std::lock_guard<std::mutex> lock(m_connection_mutex);
-    if (m_connections.empty()) {
+void WebSocketServer::process_message_queue() {
+    m_drained.clear();
+    m_message_queue->drain(m_drained);
+    if (m_drained.empty()) {
         return;
     }
-    
-    plugin_log_printf("[WS] Broadcasting %zu messages to %zu clients.", messages_to_send.size(), m_connections.size());
+    TraceScope trace("drain");
+    trace.set_arg(m_drained.size());
 
-    for (const auto& msg : messages_to_send) {
-        for (auto const& hdl : m_connections) {
-            m_server.send(hdl, msg, websocketpp::frame::opcode::text);
+    // Zusätzliche Ausgänge bekommen jedes Frame, unabhängig davon, ob WebSocket-Clients verbunden sind
+    for (const auto& frame : m_drained) {
+        // Beides vor dem Verteilen, siehe WsShard::replay_journal
+        if (frame->kind == MessageKind::gameplay || frame->kind == MessageKind::config) {
+            m_shared.journal.append(*frame);
+        } else if (frame->seq != 0) {
+            m_shared.journal.note_seq(frame->seq);
         }
+        for (size_t i = 1; i < m_shards.size(); ++i) {
+            m_shards[i]->post(frame);
+        }
+        if (frame->kind == MessageKind::usage) continue; // nur für WebSocket-Clients
+        if (m_shm_sink) m_shm_sink->write(*frame);
+        if (frame->kind == MessageKind::snapshot) continue;
+        if (m_udp_sink) m_udp_sink->send(*frame);
+        if (m_stream_sink) m_stream_sink->send(frame);
     }
-}
-
-void WebSocketServer::on_open(connection_hdl hdl) {
-    std::lock_guard<std::mutex> lock(m_connection_mutex);
-    m_connections.insert(hdl);
-    plugin_log_printf("[WS] Client connected. Total clients: %zu", m_connections.size());
-    m_server.send(hdl, "{\"welcome\":\"ok\"}", websocketpp::frame::opcode::text);
-}
 
-void WebSocketServer::on_close(connection_hdl hdl) {
-    std::lock_guard<std::mutex> lock(m_connection_mutex);
-    m_connections.erase(hdl);
-    plugin_log_printf("[WS] Client disconnected. Total clients: %zu", m_connections.size());
+    m_shards.front()->deliver(m_drained);
+    m_drained.clear();
 }
 
-void WebSocketServer::on_message(connection_hdl hdl, server_t::message_ptr msg) {
-    // Nicht implementiert, da wir nur senden
+// Läuft im Server-Thread; geht wie ein Frame durch die Warteschlange, damit
+// auch die Shards in eigenen Threads die Nachricht bekommen
+void WebSocketServer::broadcast_usage() {
+    auto frame = std::make_shared<EncodedFrame>();
+    frame->kind = MessageKind::usage;
+    const std::string message = usage_message();
+    frame->json.assign(message.data(), message.size());
+    m_message_queue->push(std::move(frame));
 }
 
 // Globale Instanz
@@ -1,49 +1,74 @@
 #pragma once
-#include <websocketpp/config/asio_no_tls.hpp>
-#include <websocketpp/server.hpp>
+#include "accept_backoff.hpp"
+#include "config.hpp"
+#include "encoded_frame.hpp"
+#include "frame_queue.hpp"
+#include "ws_shard.hpp"
+#include "udp_sink.hpp"
+#include "shm_ring_sink.hpp"
+#include "stream_sink.hpp"
 
 #include <string>
 #include <thread>
 #include <mutex>
-#include <set>
 #include <vector>
 #include <atomic>
+#include <chrono>
+#include <memory>
 
 class WebSocketServer {
 public:
     WebSocketServer();
     ~WebSocketServer();
 
-    bool start(unsigned short port);
+    bool start(const PluginConfig& cfg);
     void stop();
     bool is_running() const;
 
-    // Fügt eine Nachricht zur Broadcast-Warteschlange hinzu (Thread-sicher)
-    void queue_broadcast(const std::string& msg);
+    // Fügt eine Nachricht zur Broadcast-Warteschlange hinzu (Thread-sicher, wartet nie)
+    void queue_broadcast(EncodedFramePtr frame);
 
-private:
-    using config_t = websocketpp::config::asio;
-    using server_t = websocketpp::server<config_t>;
-    using connection_hdl = websocketpp::connection_hdl;
+    // Überlaufzähler der Warteschlange
+    uint64_t queue_frames_dropped() const { return m_message_queue ? m_message_queue->frames_dropped() : 0; }
+    uint64_t queue_events_overflowed() const { return m_message_queue ? m_message_queue->events_overflowed() : 0; }
+
+    // Snapshot-Anforderungen der HTTP-Endpunkte (vom Spiel-Thread pro Frame abgefragt)
+    uint64_t snapshot_generation() const { return m_shared.snapshot_generation.load(std::memory_order_relaxed); }
+    bool snapshot_wanted() const;
+
+    // Mindestens ein WebSocket-Client möchte MessagePack statt JSON
+    bool msgpack_wanted() const { return m_shared.msgpack_clients.load(std::memory_order_relaxed) > 0; }
 
+private:
     void run_server();
+    void accept_next();
     void process_message_queue();
+    void broadcast_usage();
 
-    server_t m_server;
     std::thread m_thread;
     std::atomic<bool> m_running;
 
-    // Verbindungen und Nachrichten-Queue
-    std::mutex m_connection_mutex;
-    std::set<connection_hdl, std::owner_less<connection_hdl>> m_connections;
+    // Shard 0 läuft im Server-Thread, hält den Listener und die zusätzlichen
+    // Ausgänge; weitere Shards (ws_threads > 1) haben eigene Threads
+    ShardShared m_shared;
+    std::vector<std::unique_ptr<WsShard>> m_shards;
+    size_t m_next_shard = 0;
+
+    std::unique_ptr<FrameQueue> m_message_queue;
+    std::vector<EncodedFramePtr> m_drained;
+
+    // Periodische Verbrauchsnachricht {"type":"usage"} (usage_interval_s, 0 = aus)
+    std::chrono::seconds m_usage_interval{0};
+    std::chrono::steady_clock::time_point m_next_usage;
 
-    std::mutex m_queue_mutex;
-    std::vector<std::string> m_message_queue;
+    // Listener für alle Shards, auf dem io_service von Shard 0
+    std::unique_ptr<websocketpp::lib::asio::ip::tcp::acceptor> m_acceptor;
+    std::unique_ptr<AcceptBackoff> m_accept_backoff;
 
-    // Handler
-    void on_open(connection_hdl hdl);
-    void on_close(connection_hdl hdl);
-    void on_message(connection_hdl hdl, server_t::message_ptr msg);
+    // Optionale zusätzliche Ausgänge (laufen auf dem io_service von Shard 0)
+    std::unique_ptr<UdpSink> m_udp_sink;
+    std::unique_ptr<ShmRingSink> m_shm_sink;
+    std::unique_ptr<StreamSink> m_stream_sink;
 };
 
 // Globale Instanz
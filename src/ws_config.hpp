@@ -0,0 +1,122 @@
+#pragma once
+// websocketpp-Konfiguration für unseren Broadcast-Server.
+//
+// Jeder Endpoint (einer pro Shard) wird nur von einem Thread angefasst: Shard 0
+// vom Server-Thread, die übrigen von ihrem eigenen Thread. Verbindungen werden
+// im Thread ihres Shards angelegt (WsShard::adopt), Nachrichten kommen über
+// Postfächer bzw. die sperrfreie FrameQueue. Deshalb:
+//   - keine echten Mutexe (concurrency::none), keine Strands
+//   - Logger zur Compile-Zeit abgeschaltet (log::stub)
+//   - wiederverwendete Nachrichtenpuffer pro Verbindung
+//   - kleine Puffer/Limits, Clients schicken nur kurze Steuernachrichten
+
+#include <websocketpp/config/asio_no_tls.hpp>
+#include <websocketpp/concurrency/none.hpp>
+#include <websocketpp/logger/stub.hpp>
+#include <websocketpp/message_buffer/message.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace scs_ws {
+
+// Wie message_buffer::alloc::con_msg_manager, aber mit kleinem Pool: eine
+// Nachricht wird wiederverwendet, sobald nur noch der Pool sie hält.
+// (message_buffer/pool.hpp aus websocketpp 0.8 ist nur ein Gerüst.)
+template <typename message>
+class pooled_con_msg_manager : public std::enable_shared_from_this<pooled_con_msg_manager<message>> {
+public:
+    typedef pooled_con_msg_manager<message> type;
+    typedef std::shared_ptr<type> ptr;
+    typedef std::weak_ptr<type> weak_ptr;
+    typedef typename message::ptr message_ptr;
+
+    static const size_t pool_size = 4;
+
+    message_ptr get_message() {
+        return acquire(websocketpp::frame::opcode::text, 0);
+    }
+
+    message_ptr get_message(websocketpp::frame::opcode::value op, size_t size) {
+        return acquire(op, size);
+    }
+
+    bool recycle(message*) {
+        return false;
+    }
+
+private:
+    message_ptr acquire(websocketpp::frame::opcode::value op, size_t size) {
+        for (const auto& msg : m_pool) {
+            if (msg.use_count() != 1) continue;
+            msg->set_opcode(op);
+            msg->set_header(std::string());
+            msg->set_prepared(false);
+            msg->set_fin(true);
+            msg->set_terminal(false);
+            msg->set_compressed(false);
+            msg->get_raw_payload().clear();
+            msg->get_raw_payload().reserve(size);
+            return msg;
+        }
+        message_ptr msg = std::make_shared<message>(type::shared_from_this(), op, size);
+        if (m_pool.size() < pool_size) m_pool.push_back(msg);
+        return msg;
+    }
+
+    std::vector<message_ptr> m_pool;
+};
+
+template <typename con_msg_manager>
+class pooled_endpoint_msg_manager {
+public:
+    typedef typename con_msg_manager::ptr con_msg_man_ptr;
+
+    con_msg_man_ptr get_manager() const {
+        return std::make_shared<con_msg_manager>();
+    }
+};
+
+struct server_config : public websocketpp::config::asio {
+    typedef server_config type;
+    typedef websocketpp::config::asio base;
+
+    typedef websocketpp::concurrency::none concurrency_type;
+
+    typedef base::request_type request_type;
+    typedef base::response_type response_type;
+
+    typedef websocketpp::message_buffer::message<pooled_con_msg_manager> message_type;
+    typedef pooled_con_msg_manager<message_type> con_msg_manager_type;
+    typedef pooled_endpoint_msg_manager<con_msg_manager_type> endpoint_msg_manager_type;
+
+    typedef websocketpp::log::stub alog_type;
+    typedef websocketpp::log::stub elog_type;
+
+    typedef base::rng_type rng_type;
+
+    static bool const enable_multithreading = false;
+
+    struct transport_config : public base::transport_config {
+        typedef type::concurrency_type concurrency_type;
+        typedef type::alog_type alog_type;
+        typedef type::elog_type elog_type;
+        typedef type::request_type request_type;
+        typedef type::response_type response_type;
+        typedef websocketpp::transport::asio::basic_socket::endpoint socket_type;
+
+        static bool const enable_multithreading = false;
+    };
+
+    typedef websocketpp::transport::asio::endpoint<transport_config> transport_type;
+
+    // Eingehend kommen nur Steuernachrichten und HTTP-Anfragen ohne Body
+    static const size_t connection_read_buffer_size = 4096;
+    static const size_t max_message_size = 64 * 1024;
+    static const size_t max_http_body_size = 64 * 1024;
+
+    static const websocketpp::log::level elog_level = websocketpp::log::elevel::none;
+    static const websocketpp::log::level alog_level = websocketpp::log::alevel::none;
+};
+
+} // namespace scs_ws
@@ -0,0 +1,885 @@
+#include "ws_shard.hpp"
+#include "plugin_log.hpp"
+#include "latency_stats.hpp"
+#include "plugin_metrics.hpp"
+#include "trace_recorder.hpp"
+#include "usage_stats.hpp"
+#include "frame_timing.hpp"
+#include <chrono>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <nlohmann/json.hpp>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+static int64_t steady_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int64_t steady_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Nachrichtenarten, die Clients mit "subscribe" wählen können (auch für /clients)
+static const struct {
+    const char* name;
+    MessageKind kind;
+} subscribable_kinds[] = {
+    {"frame", MessageKind::frame},
+    {"gameplay", MessageKind::gameplay},
+    {"config", MessageKind::config},
+    {"usage", MessageKind::usage},
+};
+
+// Unix-Zeit in Millisekunden (dieselbe Uhr wie "timestamp" in den Frames, nur feiner)
+static double unix_time_ms() {
+    return std::chrono::duration<double, std::milli>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+WsShard::WsShard(size_t index, ShardShared& shared) : m_index(index), m_shared(shared) {
+    m_server.set_validate_handler([this](connection_hdl hdl) { return this->on_validate(hdl); });
+    m_server.set_open_handler([this](connection_hdl hdl) { this->on_open(hdl); });
+    m_server.set_fail_handler([this](connection_hdl hdl) { this->on_fail(hdl); });
+    m_server.set_close_handler([this](connection_hdl hdl) { this->on_close(hdl); });
+    m_server.set_message_handler([this](connection_hdl hdl, server_t::message_ptr msg) { this->on_message(hdl, msg); });
+    m_server.set_http_handler([this](connection_hdl hdl) { this->on_http(hdl); });
+    m_server.set_pong_handler([this](connection_hdl hdl, std::string payload) { this->on_pong(hdl, payload); });
+
+    m_server.clear_access_channels(websocketpp::log::alevel::all);
+    m_server.clear_error_channels(websocketpp::log::elevel::all);
+    m_server.init_asio();
+}
+
+WsShard::~WsShard() {
+    stop_thread();
+}
+
+void WsShard::adopt(websocketpp::lib::asio::ip::tcp::socket socket) {
+    auto accepted = std::make_shared<websocketpp::lib::asio::ip::tcp::socket>(std::move(socket));
+    m_server.get_io_service().post([this, accepted]() {
+        server_t::connection_ptr con = m_server.get_connection();
+        if (!con) {
+            websocketpp::lib::asio::error_code ec;
+            accepted->close(ec);
+            return;
+        }
+        // Wie endpoint::handle_accept, nur mit unserem Socket statt dem der Verbindung
+        con->get_raw_socket() = std::move(*accepted);
+        con->start();
+    });
+}
+
+void WsShard::start_thread(const PluginConfig& cfg) {
+    m_inbox.reset(new FrameQueue(static_cast<size_t>(std::max(cfg.queue_capacity, 16)),
+                                 cfg.queue_overflow == "drop_newest" ? FrameQueue::Overflow::drop_newest
+                                                                     : FrameQueue::Overflow::drop_oldest));
+    // Ohne Listener hätte der io_service anfangs nichts zu tun und würde beim ersten poll() stehen bleiben
+    m_server.start_perpetual();
+    m_running.store(true);
+    m_thread = std::thread(&WsShard::run, this);
+#ifdef _WIN32
+    if (cfg.ws_thread_affinity != 0) {
+        if (!SetThreadAffinityMask(m_thread.native_handle(), static_cast<DWORD_PTR>(cfg.ws_thread_affinity))) {
+            PLOG_WARN(ws, "Shard %zu: SetThreadAffinityMask failed (%lu).", m_index, GetLastError());
+        }
+    }
+#endif
+}
+
+void WsShard::stop_thread() {
+    if (!m_running.exchange(false)) return;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    PLOG_INFO(ws, "Shard %zu stopped: high water %zu, %llu frames dropped.", m_index, m_inbox->high_water(),
+              static_cast<unsigned long long>(m_inbox->frames_dropped()));
+}
+
+void WsShard::run() {
+    trace_name_thread("ws shard");
+    std::vector<EncodedFramePtr> frames;
+    while (m_running.load()) {
+        try {
+            m_server.poll();
+
+            frames.clear();
+            m_inbox->drain(frames);
+            if (!frames.empty()) deliver(frames);
+
+            service();
+            usage_sample_thread(UsageThread::shard);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        } catch (const std::exception& e) {
+            PLOG_ERROR(ws, "Shard %zu: exception in loop: %s", m_index, e.what());
+        }
+    }
+    shutdown();
+}
+
+void WsShard::shutdown() {
+    try {
+        // Alle Verbindungen schließen und den Close-Handshake kurz abwarten
+        ConnectionRegistry::ListPtr connections = m_connections.snapshot();
+        for (const auto& conn : *connections) {
+            websocketpp::lib::error_code ec;
+            m_server.close(conn->hdl, websocketpp::close::status::going_away, "Server shutdown", ec);
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(250);
+        while (!m_connections.snapshot()->empty() && std::chrono::steady_clock::now() < deadline) {
+            m_server.poll();
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    } catch (const std::exception& e) {
+        PLOG_WARN(ws, "Exception while closing connections: %s", e.what());
+    }
+    m_sse_hub.stop();
+    m_pending_http.clear();
+    m_shared.clients.fetch_sub(static_cast<int>(m_sse_reported + m_reserved.size()), std::memory_order_relaxed);
+    m_reserved.clear();
+    m_shared.buffered_bytes.fetch_sub(static_cast<int64_t>(m_buffered_reported), std::memory_order_relaxed);
+    m_sse_reported = 0;
+    m_buffered_reported = 0;
+    m_server.stop(); // Stoppt den poll-Vorgang
+}
+
+void WsShard::deliver(const std::vector<EncodedFramePtr>& frames) {
+    TRACE_SCOPE("deliver");
+    if (m_shared.sse_used.load(std::memory_order_relaxed)) m_sse_hub.keep_history();
+    for (const auto& frame : frames) {
+        if (frame->kind == MessageKind::usage) continue; // nur WebSocket
+        m_snapshot_cache.on_frame(frame);
+        m_sse_hub.send(frame);
+    }
+
+    // Schnappschuss der Verbindungsliste, Öffnen/Schließen blockiert den Broadcast nicht
+    ConnectionRegistry::ListPtr connections = m_connections.snapshot();
+    if (connections->empty()) {
+        return;
+    }
+
+    PLOG_TRACE(ws, "Broadcasting %zu messages to %zu clients.", frames.size(), connections->size());
+
+    for (const auto& frame : frames) {
+        server_t::message_ptr text_msg;
+        server_t::message_ptr binary_msg;
+        if (frame->kind == MessageKind::snapshot) {
+            // Snapshots bekommen nur gedrosselte Verbindungen, deren verworfene Frames ersetzt werden müssen
+            for (const auto& conn : *connections) {
+                ConnectionState& state = *conn;
+                if (!state.resync_pending || state.closing || !state.wants(MessageKind::frame)) continue;
+                state.resync_pending = false;
+                bool binary = state.msgpack && !frame->msgpack.empty();
+                server_t::message_ptr& msg = binary ? binary_msg : text_msg;
+                if (!msg) msg = prepare_message(*frame, binary);
+                enqueue(state, msg, false);
+            }
+            continue;
+        }
+        for (const auto& conn : *connections) {
+            ConnectionState& state = *conn;
+            if (state.closing || !state.wants(frame->kind)) continue;
+            const bool event = frame->kind == MessageKind::gameplay || frame->kind == MessageKind::config;
+            if (event && frame->seq <= state.replayed_until) continue;
+            const uint32_t divisor = state.rate_divisor << state.degrade_level;
+            if (frame->full_state && divisor > 1 && (state.rate_phase++ % divisor) != 0) {
+                state.messages_skipped.fetch_add(1, std::memory_order_relaxed);
+                g_metrics.frames_skipped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            // MessagePack nur, wenn das Frame es schon enthält (direkt nach dem Umschalten evtl. noch nicht)
+            bool binary = state.msgpack && !frame->msgpack.empty();
+            server_t::message_ptr& msg = binary ? binary_msg : text_msg;
+            if (!msg) msg = prepare_message(*frame, binary);
+            enqueue(state, msg, event);
+        }
+    }
+
+    for (const auto& conn : *connections) {
+        flush(*conn);
+    }
+}
+
+void WsShard::enqueue(ConnectionState& state, const server_t::message_ptr& msg, bool event) {
+    state.lane_bytes += msg->get_payload().size();
+    if (event) {
+        state.event_lane.push_back(msg);
+        return;
+    }
+    if (state.frame_lane.size() >= frame_lane_limit) {
+        state.lane_bytes -= state.frame_lane.front()->get_payload().size();
+        state.frame_lane.pop_front();
+        state.frames_dropped.fetch_add(1, std::memory_order_relaxed);
+        g_metrics.frames_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    state.frame_lane.push_back(msg);
+}
+
+// Übergibt wartende Nachrichten an websocketpp, Ereignisse zuerst. Die Reihenfolge
+// zwischen Ereignissen und Frames kann sich dabei ändern, Clients sortieren über "seq".
+// Liefert, was danach noch für die Verbindung wartet, und prüft das Budget.
+size_t WsShard::flush(ConnectionState& state) {
+    LATENCY_TIMER(latency, client_send);
+    TraceScope trace("send");
+    websocketpp::lib::error_code ec;
+    server_t::connection_ptr con = m_server.get_con_from_hdl(state.hdl, ec);
+    if (ec || !con) {
+        trace.dismiss();
+        LATENCY_DISMISS(latency);
+        return 0;
+    }
+
+    uint64_t messages[2] = {0, 0}; // Text (JSON), binär (MessagePack)
+    uint64_t bytes[2] = {0, 0};
+    uint64_t header_bytes = 0;
+    while (con->get_buffered_amount() < send_high_water) {
+        ConnectionState::Lane& lane = state.event_lane.empty() ? state.frame_lane : state.event_lane;
+        if (lane.empty()) break;
+        server_t::message_ptr msg = std::move(lane.front());
+        lane.pop_front();
+        state.lane_bytes -= msg->get_payload().size();
+
+        ec = con->send(msg);
+        if (ec) break;
+        const int format = msg->get_opcode() == websocketpp::frame::opcode::binary ? 1 : 0;
+        ++messages[format];
+        bytes[format] += msg->get_payload().size();
+        header_bytes += msg->get_header().size();
+    }
+    if (messages[0] + messages[1] == 0) {
+        // Nichts übergeben: weder Spanne noch Laufzeit, sonst überwiegen die leeren Durchläufe
+        trace.dismiss();
+        LATENCY_DISMISS(latency);
+    }
+    trace.set_arg(messages[0] + messages[1]);
+    if (messages[0] + messages[1] > 0) {
+        state.messages_sent.fetch_add(messages[0] + messages[1], std::memory_order_relaxed);
+        state.bytes_sent.fetch_add(bytes[0] + bytes[1], std::memory_order_relaxed);
+        state.wire_bytes_sent.fetch_add(bytes[0] + bytes[1] + header_bytes, std::memory_order_relaxed);
+        g_metrics.messages_sent_json.fetch_add(messages[0], std::memory_order_relaxed);
+        g_metrics.bytes_sent_json.fetch_add(bytes[0], std::memory_order_relaxed);
+        g_metrics.messages_sent_msgpack.fetch_add(messages[1], std::memory_order_relaxed);
+        g_metrics.bytes_sent_msgpack.fetch_add(bytes[1], std::memory_order_relaxed);
+    }
+
+    size_t buffered = con->get_buffered_amount() + state.lane_bytes;
+    state.buffered_bytes.store(buffered, std::memory_order_relaxed);
+    if (m_shared.max_connection_buffer > 0 && buffered > m_shared.max_connection_buffer) {
+        over_budget(state, buffered, "connection");
+        buffered = state.buffered_bytes.load(std::memory_order_relaxed);
+    }
+    return buffered;
+}
+
+// Eine Verbindung liegt über ihrem (oder dem gesamten) Puffer-Budget: wartende Frames
+// verwerfen und die Voll-Frame-Rate halbieren; wer nach max_degrade_level Stufen
+// (oder mit buffer_limit_policy=disconnect) immer noch darüber liegt, wird mit 1013 getrennt.
+// Ereignisse bleiben erhalten, die Verbindung setzt mit dem nächsten Snapshot neu auf.
+void WsShard::over_budget(ConnectionState& state, size_t buffered, const char* which) {
+    if (state.closing) return;
+    auto now = std::chrono::steady_clock::now();
+    // Innerhalb einer Sekunde nach der letzten Stufe nur Frames verwerfen, die Drosselung wirkt noch
+    const bool escalate = state.degrade_level == 0 || now - state.degraded_at >= std::chrono::seconds(1);
+
+    if (escalate && (m_shared.disconnect_on_limit || state.degrade_level >= max_degrade_level)) {
+        PLOG_WARN(ws, "Closing client over %s buffer limit (%zu bytes).", which, buffered);
+        state.closing = true;
+        state.event_lane.clear();
+        state.frame_lane.clear();
+        state.lane_bytes = 0;
+        websocketpp::lib::error_code ec;
+        m_server.close(state.hdl, websocketpp::close::status::try_again_later, "Send buffer limit exceeded", ec);
+        return;
+    }
+
+    size_t dropped = state.frame_lane.size();
+    size_t dropped_bytes = 0;
+    for (const auto& msg : state.frame_lane) dropped_bytes += msg->get_payload().size();
+    state.frame_lane.clear();
+    state.lane_bytes -= dropped_bytes;
+    state.frames_dropped.fetch_add(dropped, std::memory_order_relaxed);
+    g_metrics.frames_dropped.fetch_add(dropped, std::memory_order_relaxed);
+    state.buffered_bytes.store(buffered - dropped_bytes, std::memory_order_relaxed);
+    if (!escalate) return;
+
+    ++state.degrade_level;
+    state.degraded_at = now;
+    state.publish_settings();
+    state.resync_pending = true;
+    request_snapshot();
+    m_shared.snapshot_generation.fetch_add(1, std::memory_order_relaxed);
+    PLOG_WARN(ws, "Client over %s buffer limit (%zu bytes): dropped %zu frames, rate tier %u.", which, buffered,
+              dropped, state.degrade_level);
+}
+
+// Reserviert einen Platz für eine weitere Verbindung (WebSocket oder SSE). Gezählt
+// wird sofort, damit gleichzeitige Handshakes auf mehreren Shards das Limit nicht
+// gemeinsam überschreiten. Freigegeben wird in on_fail/on_close bzw. service().
+bool WsShard::admit() {
+    int clients = m_shared.clients.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (m_shared.max_clients <= 0 || clients <= m_shared.max_clients) {
+        return true;
+    }
+    m_shared.clients.fetch_sub(1, std::memory_order_relaxed);
+    PLOG_WARN(ws, "Rejecting connection, max_connections (%d) reached.", m_shared.max_clients);
+    return false;
+}
+
+bool WsShard::on_validate(connection_hdl hdl) {
+    if (admit()) {
+        m_reserved.insert(hdl);
+        return true;
+    }
+    m_server.get_con_from_hdl(hdl)->set_status(websocketpp::http::status_code::service_unavailable);
+    return false;
+}
+
+// Handshake nach on_validate gescheitert: der reservierte Platz wird wieder frei
+void WsShard::on_fail(connection_hdl hdl) {
+    if (m_reserved.erase(hdl) > 0) m_shared.clients.fetch_sub(1, std::memory_order_relaxed);
+}
+
+WsShard::server_t::message_ptr WsShard::prepare_message(const EncodedFrame& frame, bool binary) {
+    const FrameBuffer& payload = binary ? frame.msgpack : frame.json;
+    const websocketpp::frame::opcode::value opcode = binary ? websocketpp::frame::opcode::binary : websocketpp::frame::opcode::text;
+
+    // Eine Nachricht ist frei, wenn keine Verbindung sie mehr in ihrer Sende-Queue hat
+    server_t::message_ptr msg;
+    for (const auto& pooled : m_message_pool) {
+        if (pooled.use_count() == 1) {
+            msg = pooled;
+            break;
+        }
+    }
+    if (!msg) {
+        msg = std::make_shared<config_t::message_type>(config_t::message_type::con_msg_man_ptr(), opcode, payload.size());
+        if (m_message_pool.size() < 256) m_message_pool.push_back(msg);
+    }
+
+    // Server-Frames sind unmaskiert, Kopf und Nutzlast können also für alle Verbindungen gleich sein
+    msg->set_opcode(opcode);
+    msg->get_raw_payload().assign(payload.data(), payload.size());
+    websocketpp::frame::basic_header header(opcode, payload.size(), true, false);
+    websocketpp::frame::extended_header extended(payload.size());
+    msg->set_header(websocketpp::frame::prepare_header(header, extended));
+    msg->set_prepared(true);
+    return msg;
+}
+
+void WsShard::on_open(connection_hdl hdl) {
+    server_t::connection_ptr con = m_server.get_con_from_hdl(hdl);
+    std::shared_ptr<ConnectionState> state =
+        m_connections.add(hdl, m_shared.next_client_id.fetch_add(1, std::memory_order_relaxed) + 1,
+                          con->get_remote_endpoint(), con->get_request_header("User-Agent"));
+    m_reserved.erase(hdl); // der Platz gehört jetzt dem Registry-Eintrag, frei wird er in on_close
+    PLOG_INFO(ws, "Client connected (shard %zu). Clients on shard: %zu", m_index, m_connections.snapshot()->size());
+    m_server.send(hdl, "{\"welcome\":\"ok\"}", websocketpp::frame::opcode::text);
+    replay_journal(*state, con->get_resource());
+}
+
+void WsShard::on_close(connection_hdl hdl) {
+    std::shared_ptr<ConnectionState> state = m_connections.find(hdl);
+    if (!state) return;
+    if (state->msgpack) m_shared.msgpack_clients.fetch_sub(1, std::memory_order_relaxed);
+    m_shared.clients.fetch_sub(1, std::memory_order_relaxed);
+    m_connections.remove(hdl);
+    PLOG_INFO(ws, "Client disconnected (shard %zu). Clients on shard: %zu", m_index, m_connections.snapshot()->size());
+}
+
+// Steuernachrichten der Clients, z.B.
+//   {"subscribe":["frame","gameplay","config"],"format":"msgpack","rate":4}
+// subscribe: gewünschte Nachrichtenarten, format: "json" oder "msgpack",
+// rate: nur jedes n-te Voll-Frame (Deltas werden nie ausgelassen, sonst gingen Änderungen verloren)
+void WsShard::on_message(connection_hdl hdl, server_t::message_ptr msg) {
+    std::shared_ptr<ConnectionState> state = m_connections.find(hdl);
+    if (!state || msg->get_opcode() != websocketpp::frame::opcode::text) return;
+
+    nlohmann::json request = nlohmann::json::parse(msg->get_payload(), nullptr, false);
+    if (!request.is_object()) {
+        PLOG_DEBUG(ws, "Ignoring malformed client message.");
+        return;
+    }
+
+    if (request.contains("subscribe") && request["subscribe"].is_array()) {
+        uint32_t mask = 0;
+        for (const auto& kind : request["subscribe"]) {
+            if (!kind.is_string()) continue;
+            const std::string& name = kind.get_ref<const std::string&>();
+            for (const auto& known : subscribable_kinds) {
+                if (name == known.name) mask |= 1u << static_cast<uint32_t>(known.kind);
+            }
+        }
+        state->subscriptions = mask;
+    }
+    if (request.contains("format") && request["format"].is_string()) {
+        bool msgpack = request["format"] == "msgpack";
+        if (msgpack != state->msgpack) {
+            state->msgpack = msgpack;
+            m_shared.msgpack_clients.fetch_add(msgpack ? 1 : -1, std::memory_order_relaxed);
+        }
+    }
+    if (request.contains("rate") && request["rate"].is_number_integer()) {
+        state->rate_divisor = static_cast<uint32_t>(std::max<int64_t>(1, request["rate"].get<int64_t>()));
+        state->rate_phase = 0;
+    }
+    state->publish_settings();
+
+    // Uhrenabgleich: {"clock_sync": <Client-Zeit in ms>} ->
+    //   {"type":"clock_sync","client":<dieselbe Zahl>,"server":<Unix-Zeit in ms>}
+    // Der Client rechnet offset = server - (gesendet + empfangen) / 2
+    if (request.contains("clock_sync") && request["clock_sync"].is_number()) {
+        double client_ms = request["clock_sync"].get<double>();
+        double server_ms = unix_time_ms();
+        if (state->rtt_count > 0) {
+            // Eigene Schätzung für die Statistik: die Anfrage war etwa eine halbe Laufzeit unterwegs
+            state->clock_offset_ms = server_ms - (client_ms + state->rtt_percentile(0.5) / 2000.0);
+            state->clock_synced = true;
+        }
+        nlohmann::json reply = {{"type", "clock_sync"}, {"client", request["clock_sync"]}, {"server", server_ms}};
+        websocketpp::lib::error_code ec;
+        m_server.send(hdl, reply.dump(), websocketpp::frame::opcode::text, ec);
+    }
+    if (request.contains("stats")) {
+        send_stats(*state);
+    }
+    // {"clients": true}: dasselbe wie GET /clients, alle Verbindungen aller Shards
+    if (request.contains("clients") && m_shared.clients_enabled) {
+        websocketpp::lib::error_code ec;
+        m_server.send(hdl, clients_json(), websocketpp::frame::opcode::text, ec);
+    }
+
+    // {"trace": <ms>}: Chrome-Trace der nächsten ms Millisekunden nach trace_file (nur mit trace_enabled=1)
+    //   -> {"type":"trace","started":<bool>,"duration_ms":<ms>}
+    if (request.contains("trace") && request["trace"].is_number_unsigned() && m_shared.trace_enabled) {
+        uint32_t duration_ms = std::min<uint32_t>(request["trace"].get<uint32_t>(), 60000);
+        bool started = trace_start(duration_ms, m_shared.trace_file);
+        nlohmann::json reply = {{"type", "trace"}, {"started", started}, {"duration_ms", duration_ms}};
+        websocketpp::lib::error_code ec;
+        m_server.send(hdl, reply.dump(), websocketpp::frame::opcode::text, ec);
+    }
+}
+
+// {"type":"stats", ...} mit Laufzeit-Perzentilen, Uhrenversatz und Zählern dieser Verbindung,
+// dazu die Latenz-Histogramme der Pipeline (alle Threads zusammengeführt)
+void WsShard::send_stats(ConnectionState& state) {
+    nlohmann::json rtt = {{"samples", std::min<size_t>(state.rtt_count, state.rtt_samples.size())},
+                          {"last", state.rtt_last_us.load(std::memory_order_relaxed) / 1000.0},
+                          {"p50", state.rtt_percentile(0.5) / 1000.0},
+                          {"p90", state.rtt_percentile(0.9) / 1000.0},
+                          {"p99", state.rtt_percentile(0.99) / 1000.0}};
+    nlohmann::json stats = {{"type", "stats"},
+                            {"rtt_ms", rtt},
+                            {"clock_offset_ms", state.clock_synced ? nlohmann::json(state.clock_offset_ms) : nlohmann::json()},
+                            {"messages_sent", state.messages_sent.load(std::memory_order_relaxed)},
+                            {"bytes_sent", state.bytes_sent.load(std::memory_order_relaxed)},
+                            {"messages_skipped", state.messages_skipped.load(std::memory_order_relaxed)},
+                            {"frames_dropped", state.frames_dropped.load(std::memory_order_relaxed)},
+                            {"buffered_bytes", state.buffered_bytes.load(std::memory_order_relaxed)},
+                            {"rate_tier", state.degrade_level},
+                            {"server", {{"clients", m_shared.clients.load(std::memory_order_relaxed)},
+                                        {"max_clients", m_shared.max_clients},
+                                        {"buffered_bytes", m_shared.buffered_bytes.load(std::memory_order_relaxed)},
+                                        {"max_total_buffer_bytes", m_shared.max_total_buffer},
+                                        {"max_connection_buffer_bytes", m_shared.max_connection_buffer}}},
+                            {"latency", latency_stats_json()}};
+    websocketpp::lib::error_code ec;
+    m_server.send(state.hdl, stats.dump(), websocketpp::frame::opcode::text, ec);
+}
+
+// Pings tragen den Sendezeitpunkt (steady_clock, Mikrosekunden) als Nutzlast
+void WsShard::ping_all(std::chrono::steady_clock::time_point now) {
+    m_last_ping = now;
+    std::string payload = std::to_string(steady_us());
+    ConnectionRegistry::ListPtr connections = m_connections.snapshot();
+    for (const auto& conn : *connections) {
+        websocketpp::lib::error_code ec;
+        m_server.ping(conn->hdl, payload, ec);
+    }
+}
+
+void WsShard::on_pong(connection_hdl hdl, const std::string& payload) {
+    std::shared_ptr<ConnectionState> state = m_connections.find(hdl);
+    if (!state || payload.empty()) return;
+    char* end = nullptr;
+    long long sent = std::strtoll(payload.c_str(), &end, 10);
+    if (end != payload.c_str() + payload.size()) return; // nicht unser Ping
+    int64_t rtt = steady_us() - sent;
+    if (rtt >= 0) state->add_rtt(static_cast<uint32_t>(std::min<int64_t>(rtt, UINT32_MAX)));
+}
+
+// Dekodiert %XX und '+' in Query-Parametern
+static std::string url_decode(const std::string& in) {
+    std::string out;
+    out.reserve(in.size());
+    for (size_t i = 0; i < in.size(); ++i) {
+        if (in[i] == '%' && i + 2 < in.size() && std::isxdigit(static_cast<unsigned char>(in[i + 1])) && std::isxdigit(static_cast<unsigned char>(in[i + 2]))) {
+            out += static_cast<char>(std::stoi(in.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else if (in[i] == '+') {
+            out += ' ';
+        } else {
+            out += in[i];
+        }
+    }
+    return out;
+}
+
+// Liest einen Query-Parameter aus "a=1&b=2"
+static std::string query_param(const std::string& query, const std::string& name) {
+    size_t pos = 0;
+    while (pos <= query.size()) {
+        size_t end = query.find('&', pos);
+        if (end == std::string::npos) end = query.size();
+        std::string pair = query.substr(pos, end - pos);
+        size_t eq = pair.find('=');
+        if (pair.substr(0, eq) == name) {
+            return eq == std::string::npos ? "" : url_decode(pair.substr(eq + 1));
+        }
+        pos = end + 1;
+    }
+    return "";
+}
+
+// Setzt eine JSON-Antwort mit ETag; bei passendem If-None-Match nur 304
+static void set_json_response(WsShard::server_t::connection_ptr con, const std::string& body, uint64_t seq) {
+    std::string etag = "\"" + std::to_string(seq) + "\"";
+    con->append_header("ETag", etag);
+    con->append_header("Cache-Control", "no-cache");
+    if (!con->get_request_header("If-None-Match").empty() && con->get_request_header("If-None-Match") == etag) {
+        con->set_status(websocketpp::http::status_code::not_modified);
+        return;
+    }
+    con->set_status(websocketpp::http::status_code::ok);
+    con->append_header("Content-Type", "application/json");
+    con->set_body(body);
+}
+
+// ws://host:port/?since=<seq>: verpasste Ereignisse aus dem Journal vor allen
+// neuen Daten nachliefern. Vorweg kommt
+//   {"type":"replay","since":<seq>,"count":<n>,"complete":<bool>,"reset":<bool>}
+// complete=false heißt, dass ältere Ereignisse schon aus dem Journal gefallen sind.
+// reset=true: seq stammt aus einer früheren Sitzung, geliefert wird das ganze Journal.
+void WsShard::replay_journal(ConnectionState& state, const std::string& resource) {
+    size_t qpos = resource.find('?');
+    if (qpos == std::string::npos) return;
+    std::string since_param = query_param(resource.substr(qpos + 1), "since");
+    if (since_param.empty() || !m_shared.journal.enabled()) return;
+
+    uint64_t since = 0;
+    try {
+        since = std::stoull(since_param);
+    } catch (...) {
+        PLOG_DEBUG(ws, "Ignoring invalid since '%s'.", since_param.c_str());
+        return;
+    }
+
+    std::vector<EncodedFramePtr> events;
+    const EventJournal::Replay replay = m_shared.journal.since(since, events);
+
+    nlohmann::json header = {{"type", "replay"},          {"since", since},
+                             {"count", events.size()},    {"complete", replay.complete},
+                             {"reset", replay.reset}};
+    websocketpp::lib::error_code ec;
+    m_server.send(state.hdl, header.dump(), websocketpp::frame::opcode::text, ec);
+
+    // Über die Ereignisspur, damit sie vor allen wartenden Frames rausgehen
+    for (const auto& event : events) {
+        if (!state.wants(event->kind)) continue;
+        bool binary = state.msgpack && !event->msgpack.empty();
+        enqueue(state, prepare_message(*event, binary), true);
+    }
+    // Alles bis zum neuesten Journal-Eintrag kam eben schon oder war älter als since
+    state.replayed_until = replay.until;
+    flush(state);
+    PLOG_INFO(ws, "Replayed %zu events since %llu%s%s.", events.size(), static_cast<unsigned long long>(since),
+              replay.reset ? " (unknown seq, full journal)" : "", replay.complete ? "" : " (journal incomplete)");
+}
+
+// Solange gepollt wird oder SSE-Clients kommen, hält das Plugin den Snapshot aktuell
+void WsShard::request_snapshot() {
+    m_shared.snapshot_wanted_until.store(steady_ms() + 5000, std::memory_order_relaxed);
+}
+
+void WsShard::on_http(connection_hdl hdl) {
+    server_t::connection_ptr con = m_server.get_con_from_hdl(hdl);
+    const std::string& resource = con->get_resource();
+    size_t qpos = resource.find('?');
+    std::string path = resource.substr(0, qpos);
+    std::string query = qpos == std::string::npos ? "" : resource.substr(qpos + 1);
+
+    if (con->get_request().get_method() != "GET") {
+        con->set_status(websocketpp::http::status_code::method_not_allowed);
+        return;
+    }
+
+    if (path == "/config") {
+        set_json_response(con, m_snapshot_cache.config_body(), m_snapshot_cache.config_seq());
+        return;
+    }
+
+    if (path == "/metrics" && m_shared.metrics_enabled) {
+        respond_metrics(con);
+        return;
+    }
+
+    if (path == "/clients" && m_shared.clients_enabled) {
+        con->set_status(websocketpp::http::status_code::ok);
+        con->append_header("Content-Type", "application/json");
+        con->append_header("Cache-Control", "no-cache");
+        con->set_body(clients_json());
+        return;
+    }
+
+    if (path == "/events") {
+        if (!admit()) {
+            con->set_status(websocketpp::http::status_code::service_unavailable);
+            return;
+        }
+        // Ab hier gehört die Verbindung (und ihr Platz) dem SSE-Hub, service() gleicht ab
+        ++m_sse_reported;
+        con->defer_http_response();
+        m_shared.sse_used.store(true, std::memory_order_relaxed);
+        request_snapshot();
+        EncodedFramePtr snapshot;
+        if (m_snapshot_cache.snapshot_fresh()) {
+            snapshot = m_snapshot_cache.snapshot();
+        } else {
+            m_shared.snapshot_generation.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_sse_hub.add(con, snapshot);
+        return;
+    }
+
+    if (path == "/snapshot") {
+        request_snapshot();
+
+        std::string prefix = query_param(query, "prefix");
+        if (m_snapshot_cache.snapshot_fresh()) {
+            respond_snapshot(con, prefix);
+            return;
+        }
+        // Auf den nächsten Snapshot warten (höchstens einen Frame)
+        m_shared.snapshot_generation.fetch_add(1, std::memory_order_relaxed);
+        con->defer_http_response();
+        m_pending_http.push_back({con, prefix, std::chrono::steady_clock::now()});
+        return;
+    }
+
+    con->set_status(websocketpp::http::status_code::not_found);
+    con->set_body("Not Found");
+}
+
+void WsShard::respond_snapshot(server_t::connection_ptr con, const std::string& prefix) {
+    if (!m_snapshot_cache.has_snapshot()) {
+        con->set_status(websocketpp::http::status_code::service_unavailable);
+        con->set_body("{\"error\":\"no telemetry yet\"}");
+        return;
+    }
+    set_json_response(con, m_snapshot_cache.snapshot_body(prefix), m_snapshot_cache.snapshot_seq());
+}
+
+// Prometheus-Textformat. Jeder Shard antwortet selbst; die Verbindungen der anderen
+// Shards liest er über deren Registry (Schnappschuss, nur atomare Zähler).
+void WsShard::respond_metrics(server_t::connection_ptr con) {
+    std::string body;
+    body.reserve(8192);
+    MetricsWriter out(body);
+
+    out.counter("scs_ws_frames_ingested_total", "frame_end callbacks handled by the plugin.",
+                g_metrics.frames_ingested.load(std::memory_order_relaxed));
+    out.counter("scs_ws_messages_encoded_total", "Messages encoded on the game thread (frames, snapshots, events).",
+                g_metrics.messages_encoded.load(std::memory_order_relaxed));
+    out.describe("scs_ws_messages_sent_total", "counter", "WebSocket messages handed to the network, by format.");
+    out.value("scs_ws_messages_sent_total", "format=\"json\"", g_metrics.messages_sent_json.load(std::memory_order_relaxed));
+    out.value("scs_ws_messages_sent_total", "format=\"msgpack\"", g_metrics.messages_sent_msgpack.load(std::memory_order_relaxed));
+    out.describe("scs_ws_bytes_sent_total", "counter", "WebSocket payload bytes handed to the network, by format.");
+    out.value("scs_ws_bytes_sent_total", "format=\"json\"", g_metrics.bytes_sent_json.load(std::memory_order_relaxed));
+    out.value("scs_ws_bytes_sent_total", "format=\"msgpack\"", g_metrics.bytes_sent_msgpack.load(std::memory_order_relaxed));
+    out.counter("scs_ws_frames_coalesced_total", "Frames not published because the plugin was over its frame budget.",
+                g_metrics.frames_coalesced.load(std::memory_order_relaxed));
+    out.counter("scs_ws_frame_budget_exceeded_total", "Published frames that took longer than frame_budget_us.",
+                g_metrics.frame_budget_exceeded.load(std::memory_order_relaxed));
+    out.counter("scs_ws_frame_budget_steps_total", "Changes of the frame budget level (up or down).",
+                g_metrics.frame_budget_steps.load(std::memory_order_relaxed));
+    out.gauge("scs_ws_frame_budget_level", "Frame budget level n: only every 2^n-th frame is published.",
+              g_metrics.frame_budget_level.load(std::memory_order_relaxed));
+    out.gauge("scs_ws_game_fps", "Render frames per second over the last second of game time.",
+              g_frame_timing.fps.load(std::memory_order_relaxed));
+    out.gauge("scs_ws_game_frame_interval_seconds", "Mean render time step over the last second.",
+              g_frame_timing.frame_interval_ms.load(std::memory_order_relaxed) / 1000.0);
+    out.gauge("scs_ws_game_frame_interval_max_seconds", "Longest render time step over the last second.",
+              g_frame_timing.frame_interval_max_ms.load(std::memory_order_relaxed) / 1000.0);
+    out.gauge("scs_ws_game_simulation_step_seconds", "Mean simulation time step over the last second.",
+              g_frame_timing.simulation_step_ms.load(std::memory_order_relaxed) / 1000.0);
+    out.gauge("scs_ws_game_simulation_jitter_seconds", "Standard deviation of simulation minus render time over the last second.",
+              g_frame_timing.simulation_jitter_ms.load(std::memory_order_relaxed) / 1000.0);
+    out.gauge("scs_ws_game_paused", "1 while the simulation is paused.",
+              g_frame_timing.paused.load(std::memory_order_relaxed) ? 1.0 : 0.0);
+    out.counter("scs_ws_game_pauses_total", "Finished simulation pauses.", g_frame_timing.pauses.load(std::memory_order_relaxed));
+    out.describe("scs_ws_game_paused_seconds_total", "counter", "Time spent in finished simulation pauses.");
+    out.value("scs_ws_game_paused_seconds_total", "", g_frame_timing.paused_s.load(std::memory_order_relaxed));
+    out.gauge("scs_ws_plugin_frame_time_ratio", "Share of the game thread spent in plugin callbacks over the last second.",
+              g_frame_timing.plugin_frame_ratio.load(std::memory_order_relaxed));
+    out.counter("scs_ws_frames_skipped_total", "Full-state frames skipped for rate-limited clients (superseded by the next one).",
+                g_metrics.frames_skipped.load(std::memory_order_relaxed));
+    out.counter("scs_ws_frames_dropped_total", "Frames dropped from the send queues of slow clients.",
+                g_metrics.frames_dropped.load(std::memory_order_relaxed));
+    if (m_shared.queue) {
+        out.counter("scs_ws_queue_frames_dropped_total", "Frames dropped because the game-to-server queue was full.",
+                    m_shared.queue->frames_dropped());
+        out.counter("scs_ws_queue_events_overflowed_total", "Events that had to wait in the overflow list of the full queue.",
+                    m_shared.queue->events_overflowed());
+        out.gauge("scs_ws_queue_high_water", "Most frames waiting in the game-to-server queue so far.",
+                  static_cast<double>(m_shared.queue->high_water()));
+    }
+    out.counter("scs_ws_log_lines_dropped_total", "Log lines dropped because the log ring was full.", plugin_log_dropped());
+    out.gauge("scs_ws_clients", "Connected WebSocket and SSE clients.",
+              static_cast<double>(m_shared.clients.load(std::memory_order_relaxed)));
+    out.gauge("scs_ws_buffered_bytes", "Bytes waiting to be sent to all WebSocket clients.",
+              static_cast<double>(m_shared.buffered_bytes.load(std::memory_order_relaxed)));
+
+    std::vector<ConnectionRegistry::ListPtr> lists;
+    for (const ConnectionRegistry* registry : m_shared.registries) lists.push_back(registry->shared_snapshot());
+    auto per_client = [&](const char* name, const char* type, const char* help,
+                          uint64_t (*read)(const ConnectionState&)) {
+        out.describe(name, type, help);
+        for (size_t shard = 0; shard < lists.size(); ++shard) {
+            for (const auto& state : *lists[shard]) {
+                out.value(name, "client=\"" + std::to_string(state->id) + "\",shard=\"" + std::to_string(shard) + "\"",
+                          read(*state));
+            }
+        }
+    };
+    per_client("scs_ws_client_buffered_bytes", "gauge", "Bytes waiting to be sent to this client (queue depth).",
+               [](const ConnectionState& s) -> uint64_t { return s.buffered_bytes.load(std::memory_order_relaxed); });
+    per_client("scs_ws_client_messages_sent_total", "counter", "Messages sent to this client.",
+               [](const ConnectionState& s) -> uint64_t { return s.messages_sent.load(std::memory_order_relaxed); });
+    per_client("scs_ws_client_bytes_sent_total", "counter", "Payload bytes sent to this client.",
+               [](const ConnectionState& s) -> uint64_t { return s.bytes_sent.load(std::memory_order_relaxed); });
+    per_client("scs_ws_client_wire_bytes_sent_total", "counter", "Bytes sent to this client including WebSocket framing.",
+               [](const ConnectionState& s) -> uint64_t { return s.wire_bytes_sent.load(std::memory_order_relaxed); });
+    per_client("scs_ws_client_frames_skipped_total", "counter", "Full-state frames skipped for this client.",
+               [](const ConnectionState& s) -> uint64_t { return s.messages_skipped.load(std::memory_order_relaxed); });
+    per_client("scs_ws_client_frames_dropped_total", "counter", "Frames dropped from this client's send queue.",
+               [](const ConnectionState& s) -> uint64_t { return s.frames_dropped.load(std::memory_order_relaxed); });
+
+#if SCS_WS_LATENCY_STATS
+    out.describe("scs_ws_stage_latency_seconds", "summary", "Time spent per pipeline stage (see readme).");
+    for (size_t i = 0; i < static_cast<size_t>(LatencyStage::count); ++i) {
+        LatencyStage stage = static_cast<LatencyStage>(i);
+        LatencySummary s = latency_summary(stage);
+        std::string label = std::string("stage=\"") + latency_stage_name(stage) + "\"";
+        out.value("scs_ws_stage_latency_seconds", label + ",quantile=\"0.5\"", s.p50_us / 1e6);
+        out.value("scs_ws_stage_latency_seconds", label + ",quantile=\"0.9\"", s.p90_us / 1e6);
+        out.value("scs_ws_stage_latency_seconds", label + ",quantile=\"0.99\"", s.p99_us / 1e6);
+        out.value("scs_ws_stage_latency_seconds_sum", label, s.mean_us * static_cast<double>(s.count) / 1e6);
+        out.value("scs_ws_stage_latency_seconds_count", label, s.count);
+    }
+#endif
+
+    con->set_status(websocketpp::http::status_code::ok);
+    con->append_header("Content-Type", "text/plain; version=0.0.4");
+    con->append_header("Cache-Control", "no-cache");
+    con->set_body(body);
+}
+
+// {"type":"clients","clients":[...]}: eine Zeile pro WebSocket-Verbindung aller Shards.
+// Wie /metrics nur über Schnappschüsse der Registries und atomare Felder.
+std::string WsShard::clients_json() const {
+    const auto now = std::chrono::steady_clock::now();
+    nlohmann::json clients = nlohmann::json::array();
+    for (size_t shard = 0; shard < m_shared.registries.size(); ++shard) {
+        ConnectionRegistry::ListPtr list = m_shared.registries[shard]->shared_snapshot();
+        for (const auto& conn : *list) {
+            const ConnectionState& state = *conn;
+            const uint32_t mask = state.shown_subscriptions.load(std::memory_order_relaxed);
+            nlohmann::json subscriptions = nlohmann::json::array();
+            for (const auto& known : subscribable_kinds) {
+                if ((mask >> static_cast<uint32_t>(known.kind)) & 1u) subscriptions.push_back(known.name);
+            }
+            clients.push_back({{"id", state.id},
+                               {"shard", shard},
+                               {"remote", state.remote},
+                               {"user_agent", state.user_agent},
+                               {"connected_s", std::chrono::duration<double>(now - state.opened).count()},
+                               {"format", state.shown_msgpack.load(std::memory_order_relaxed) ? "msgpack" : "json"},
+                               {"subscriptions", subscriptions},
+                               {"subscription_size", subscriptions.size()},
+                               {"rate", state.shown_rate_divisor.load(std::memory_order_relaxed)},
+                               {"rate_tier", state.shown_degrade_level.load(std::memory_order_relaxed)},
+                               {"messages_sent", state.messages_sent.load(std::memory_order_relaxed)},
+                               {"bytes_sent", state.bytes_sent.load(std::memory_order_relaxed)},
+                               {"wire_bytes_sent", state.wire_bytes_sent.load(std::memory_order_relaxed)},
+                               {"frames_skipped", state.messages_skipped.load(std::memory_order_relaxed)},
+                               {"frames_dropped", state.frames_dropped.load(std::memory_order_relaxed)},
+                               {"buffered_bytes", state.buffered_bytes.load(std::memory_order_relaxed)},
+                               {"rtt_ms", state.rtt_last_us.load(std::memory_order_relaxed) / 1000.0}});
+        }
+    }
+    nlohmann::json reply = {{"type", "clients"}, {"clients", clients}};
+    return reply.dump();
+}
+
+void WsShard::service() {
+    auto now = std::chrono::steady_clock::now();
+    if (m_shared.ping_interval.count() > 0 && now - m_last_ping >= m_shared.ping_interval) {
+        ping_all(now);
+    }
+
+    // Langsame Clients: was beim Broadcast noch nicht in den Sendepuffer passte
+    ConnectionRegistry::ListPtr connections = m_connections.snapshot();
+    size_t total = 0;
+    ConnectionState* largest = nullptr;
+    size_t largest_bytes = 0;
+    for (const auto& conn : *connections) {
+        ConnectionState& state = *conn;
+        size_t buffered = flush(state);
+        // Was an schon getrennten Verbindungen hängt, wird mit dem Close-Timeout frei und
+        // darf nicht dazu führen, dass gesunde Verbindungen für sie geopfert werden
+        if (state.closing) continue;
+        total += buffered;
+        if (buffered > largest_bytes) {
+            largest = &state;
+            largest_bytes = buffered;
+        }
+        // Gedrosselte Verbindungen stufenweise zurückholen, wenn sie 10 s lang mithalten
+        if (state.degrade_level > 0 && !state.closing && buffered == 0 &&
+            now - state.degraded_at > std::chrono::seconds(10)) {
+            --state.degrade_level;
+            state.degraded_at = now;
+            state.publish_settings();
+        }
+    }
+    m_shared.buffered_bytes.fetch_add(static_cast<int64_t>(total) - static_cast<int64_t>(m_buffered_reported), std::memory_order_relaxed);
+    m_buffered_reported = total;
+    usage_note_buffered(m_shared.buffered_bytes.load(std::memory_order_relaxed));
+    if (m_shared.max_total_buffer > 0 && largest &&
+        m_shared.buffered_bytes.load(std::memory_order_relaxed) > static_cast<int64_t>(m_shared.max_total_buffer)) {
+        over_budget(*largest, largest_bytes, "total");
+    }
+
+    m_sse_hub.tick();
+    size_t sse = m_sse_hub.session_count();
+    if (sse != m_sse_reported) {
+        m_shared.clients.fetch_add(static_cast<int>(sse) - static_cast<int>(m_sse_reported), std::memory_order_relaxed);
+        m_sse_reported = sse;
+    }
+    if (m_pending_http.empty()) return;
+
+    // Wenn kein frischer Snapshot kommt (Spiel hängt im Menü o.ä.), den letzten bekannten Stand liefern
+    bool fresh = m_snapshot_cache.snapshot_fresh();
+    for (auto it = m_pending_http.begin(); it != m_pending_http.end();) {
+        if (!fresh && now - it->since < std::chrono::milliseconds(250)) {
+            ++it;
+            continue;
+        }
+        websocketpp::lib::error_code ec;
+        respond_snapshot(it->con, it->prefix);
+        it->con->send_http_response(ec);
+        it = m_pending_http.erase(it);
+    }
+}
@@ -0,0 +1,159 @@
+#pragma once
+#include "ws_config.hpp"
+#include <websocketpp/server.hpp>
+
+#include "config.hpp"
+#include "encoded_frame.hpp"
+#include "frame_queue.hpp"
+#include "connection_registry.hpp"
+#include "event_journal.hpp"
+#include "snapshot_cache.hpp"
+#include "sse_hub.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Was sich alle Shards teilen; die Zähler liest auch der Spiel-Thread
+struct ShardShared {
+    std::atomic<int> msgpack_clients{0};
+    std::atomic<uint64_t> snapshot_generation{0};
+    std::atomic<int64_t> snapshot_wanted_until{0}; // steady_clock in Millisekunden
+    std::atomic<bool> sse_used{false};             // ab dem ersten SSE-Client führen alle Shards den Verlauf
+    EventJournal journal;                          // letzte Ereignisse für since=<seq>
+    std::chrono::milliseconds ping_interval{2000}; // vor dem Start gesetzt, 0 = keine Pings
+
+    // Belegung und Grenzen (Grenzen vor dem Start gesetzt, 0 = unbegrenzt)
+    std::atomic<int> clients{0};                   // WebSocket- und SSE-Verbindungen aller Shards
+    std::atomic<int64_t> buffered_bytes{0};        // wartende Sendedaten aller nicht schließenden WebSocket-Verbindungen
+    int max_clients = 0;
+    size_t max_connection_buffer = 0;
+    size_t max_total_buffer = 0;
+    bool disconnect_on_limit = false;              // sonst erst drosseln, dann trennen
+
+    // Für /metrics: Verbindungen aller Shards und die Warteschlange vom Spiel-Thread (vor dem Start gesetzt)
+    bool metrics_enabled = true;
+    bool clients_enabled = false;                  // /clients und {"clients":true}
+    std::vector<const ConnectionRegistry*> registries;
+    const FrameQueue* queue = nullptr;
+    std::atomic<uint64_t> next_client_id{0};
+
+    // Chrome-Trace per Steuernachricht {"trace": <ms>}
+    bool trace_enabled = false;
+    std::string trace_file;
+};
+
+// Ein websocketpp-Endpunkt mit eigenem io_service und den Verbindungen, die ihm
+// zugeteilt wurden. Jeder Shard wird von genau einem Thread bedient (Shard 0 vom
+// Server-Thread, weitere von eigenen Threads), websocketpp braucht also keine
+// Sperren. HTTP (/snapshot, /config, /events) beantwortet jeder Shard selbst aus
+// seinem eigenen Snapshot-Cache.
+class WsShard {
+public:
+    using config_t = scs_ws::server_config;
+    using server_t = websocketpp::server<config_t>;
+    using connection_hdl = websocketpp::connection_hdl;
+
+    // Neue Nachrichten gehen erst an websocketpp, wenn dort weniger als so viele Bytes warten;
+    // bis dahin bleiben sie in den Spuren der Verbindung, wo Ereignisse noch überholen können
+    static constexpr size_t send_high_water = 64 * 1024;
+    // Frames, die pro Verbindung höchstens zurückgehalten werden (ca. 2 s bei 60 FPS)
+    static constexpr size_t frame_lane_limit = 120;
+    // Drosselstufen, bevor eine Verbindung über dem Budget getrennt wird
+    static constexpr uint32_t max_degrade_level = 4;
+
+    WsShard(size_t index, ShardShared& shared);
+    ~WsShard();
+
+    WsShard(const WsShard&) = delete;
+    WsShard& operator=(const WsShard&) = delete;
+
+    server_t& server() { return m_server; }
+    size_t index() const { return m_index; }
+    const ConnectionRegistry& connections() const { return m_connections; }
+
+    // Übernimmt einen angenommenen Socket (auf dem io_service dieses Shards angelegt).
+    // Die websocketpp-Verbindung dazu entsteht erst im Thread des Shards.
+    void adopt(websocketpp::lib::asio::ip::tcp::socket socket);
+
+    // Nur Thread des Shards: Nachrichten an die eigenen WebSocket- und SSE-Clients
+    void deliver(const std::vector<EncodedFramePtr>& frames);
+
+    // Nur Thread des Shards: zurückgestellte HTTP-Antworten, SSE-Keepalive
+    void service();
+
+    // Schließt alle Verbindungen und wartet kurz auf den Close-Handshake,
+    // danach wird der Endpunkt gestoppt
+    void shutdown();
+
+    // Weitere Shards laufen in einem eigenen Thread und bekommen die
+    // Nachrichten über eine eigene Warteschlange
+    void start_thread(const PluginConfig& cfg);
+    void stop_thread();
+    void post(const EncodedFramePtr& frame) { m_inbox->push(frame); }
+
+private:
+    void run();
+    server_t::message_ptr prepare_message(const EncodedFrame& frame, bool binary);
+    void enqueue(ConnectionState& state, const server_t::message_ptr& msg, bool event);
+    size_t flush(ConnectionState& state);
+    void over_budget(ConnectionState& state, size_t buffered, const char* which);
+    bool admit();
+    void request_snapshot();
+    void replay_journal(ConnectionState& state, const std::string& resource);
+
+    // Handler
+    bool on_validate(connection_hdl hdl);
+    void on_open(connection_hdl hdl);
+    void on_fail(connection_hdl hdl);
+    void on_close(connection_hdl hdl);
+    void on_message(connection_hdl hdl, server_t::message_ptr msg);
+    void on_pong(connection_hdl hdl, const std::string& payload);
+    void ping_all(std::chrono::steady_clock::time_point now);
+    void send_stats(ConnectionState& state);
+    void on_http(connection_hdl hdl);
+    void respond_snapshot(server_t::connection_ptr con, const std::string& prefix);
+    void respond_metrics(server_t::connection_ptr con);
+    std::string clients_json() const;
+
+    size_t m_index;
+    ShardShared& m_shared;
+    server_t m_server;
+
+    // Eigener Thread und Eingangs-Warteschlange (nicht bei Shard 0)
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::unique_ptr<FrameQueue> m_inbox;
+
+    // Verbindungen (copy-on-write)
+    ConnectionRegistry m_connections;
+
+    // Angenommen, aber noch nicht offen: halten schon einen Platz in ShardShared::clients
+    std::set<connection_hdl, std::owner_less<connection_hdl>> m_reserved;
+
+    // Fertig gerahmte WebSocket-Nachrichten, die sich alle Verbindungen teilen
+    std::vector<server_t::message_ptr> m_message_pool;
+
+    // HTTP-Endpunkte /snapshot und /config
+    struct PendingHttpRequest {
+        server_t::connection_ptr con; // hält die zurückgestellte Verbindung am Leben
+        std::string prefix;
+        std::chrono::steady_clock::time_point since;
+    };
+    SnapshotCache m_snapshot_cache;
+    std::vector<PendingHttpRequest> m_pending_http;
+
+    // Server-Sent Events unter /events
+    SseHub m_sse_hub;
+
+    std::chrono::steady_clock::time_point m_last_ping;
+
+    // Was dieser Shard zuletzt in ShardShared eingetragen hat (SSE: inkl. der in on_http reservierten)
+    size_t m_sse_reported = 0;
+    size_t m_buffered_reported = 0;
+};
@@ -0,0 +1,182 @@
+#include "test_support.hpp"
+#include "test_client.hpp"
+#include "websocket_server.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// seq aus {"seq":N,...} bzw. Ereignissen mit "seq"
+uint64_t seq_of(const std::string& message) {
+    size_t at = message.find("\"seq\":");
+    return at == std::string::npos ? 0 : std::stoull(message.substr(at + 6));
+}
+
+} // namespace
+
+// Verbindungsstürme während des Broadcasts: Clients kommen und gehen (sauber geschlossen
+// und hart abgerissen), während der Server mit 1 kHz sendet. Danach ist die Registry
+// wieder leer bis auf den festen Client, der alle Ereignisse lückenlos bekommen hat.
+TEST_CASE(churn_during_broadcast) {
+    PluginConfig cfg;
+    cfg.port = test::next_port();
+    cfg.ws_threads = 3;
+    cfg.max_connections = 0;
+    WebSocketServer server;
+    REQUIRE(server.start(cfg));
+
+    test::WsClient steady;
+    REQUIRE(steady.connect(cfg.port));
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> events_sent{0};
+    std::thread broadcaster([&] {
+        uint64_t seq = 0;
+        while (!stop) {
+            ++seq;
+            bool event = seq % 20 == 0;
+            server.queue_broadcast(test::make_frame(seq, event ? MessageKind::gameplay : MessageKind::frame,
+                                                    test::sized_json(seq, 512), "", !event));
+            if (event) ++events_sent;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    std::atomic<int> connected{0};
+    std::vector<std::thread> churners;
+    for (int t = 0; t < 3; ++t) {
+        churners.emplace_back([&, t] {
+            for (int i = 0; i < 15; ++i) {
+                if ((i + t) % 3 == 0) {
+                    // Hart abreißen: Handshake, dann Socket schließen ohne Close-Frame
+                    test::StalledClient raw;
+                    if (raw.connect(cfg.port)) ++connected;
+                } else {
+                    test::WsClient client;
+                    if (client.connect(cfg.port)) ++connected;
+                    client.wait_for([](const std::vector<std::string>& m) { return m.size() >= 3; },
+                                    std::chrono::milliseconds(200));
+                    if (i % 2 == 0) client.close();
+                    client.stop();
+                }
+            }
+        });
+    }
+    for (auto& t : churners) t.join();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    stop = true;
+    broadcaster.join();
+
+    CHECK(connected == 45);
+    CHECK(steady.is_open());
+
+    // Alle Ereignisse in Reihenfolge beim festen Client
+    CHECK(steady.wait_for([&](const std::vector<std::string>& m) {
+        uint64_t events = 0;
+        for (const auto& msg : m) events += msg.find("\"seq\":") != std::string::npos && seq_of(msg) % 20 == 0 ? 1 : 0;
+        return events == events_sent;
+    }));
+    // Ereignisse überholen wartende Frames; die Reihenfolge gilt je Art
+    uint64_t last_event = 0;
+    uint64_t last_frame = 0;
+    size_t order_errors = 0;
+    for (const auto& msg : steady.messages()) {
+        uint64_t seq = seq_of(msg);
+        if (seq == 0) continue;
+        uint64_t& last = seq % 20 == 0 ? last_event : last_frame;
+        if (seq <= last) ++order_errors;
+        last = seq;
+    }
+    CHECK(order_errors == 0);
+
+    // Abgerissene Verbindungen sind aus der Registry verschwunden
+    bool only_steady = false;
+    for (int i = 0; i < 100 && !only_steady; ++i) {
+        only_steady = test::http_get(cfg.port, "/metrics").body.find("\nscs_ws_clients 1\n") != std::string::npos;
+        if (!only_steady) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    CHECK(only_steady);
+
+    // Der Server nimmt danach ganz normal neue Clients an
+    test::WsClient late;
+    CHECK(late.connect(cfg.port));
+    server.queue_broadcast(test::make_frame(1000000, MessageKind::gameplay));
+    CHECK(late.wait_for([](const std::vector<std::string>& m) {
+        return !m.empty() && m.back().find("1000000") != std::string::npos;
+    }));
+
+    late.stop();
+    steady.stop();
+    server.stop();
+}
+
+#ifndef _WIN32
+namespace {
+
+double process_cpu_ms() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+}
+
+} // namespace
+
+// Keine freien Dateideskriptoren: accept schlägt mit EMFILE fehl, solange die
+// Verbindung in der Warteschlange liegt. Der Server darf dabei nicht im Kreis
+// drehen und nimmt wieder an, sobald Deskriptoren frei werden.
+TEST_CASE(accept_backs_off_on_emfile) {
+    PluginConfig cfg;
+    cfg.port = test::next_port();
+    cfg.ws_threads = 2;
+    WebSocketServer server;
+    REQUIRE(server.start(cfg));
+
+    int raw = socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(raw >= 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(cfg.port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    rlimit saved{};
+    getrlimit(RLIMIT_NOFILE, &saved);
+    rlimit lowered = saved;
+    lowered.rlim_cur = std::min<rlim_t>(saved.rlim_cur, 1024);
+    setrlimit(RLIMIT_NOFILE, &lowered);
+    std::vector<int> hogs;
+    for (int fd; (fd = dup(raw)) >= 0;) hogs.push_back(fd);
+
+    // Verbindungsaufbau braucht keinen neuen Deskriptor, das accept des Servers schon
+    REQUIRE(connect(raw, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const double cpu_before = process_cpu_ms();
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    const double spent = process_cpu_ms() - cpu_before;
+
+    for (int fd : hogs) close(fd);
+    setrlimit(RLIMIT_NOFILE, &saved);
+    close(raw);
+
+    // Ohne Pause liefe der Server-Thread die ganze Zeit voll
+    CHECK(spent < 150.0);
+
+    test::WsClient client;
+    CHECK(client.connect(cfg.port, "/", std::chrono::seconds(4)));
+    client.stop();
+    server.stop();
+}
+#endif
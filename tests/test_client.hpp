@@ -0,0 +1,197 @@
+#pragma once
+// Hilfsclients für die Servertests: blockierendes HTTP/1.1-GET und ein
+// WebSocket-Client in eigenem Thread, der alle Nachrichten sammelt.
+
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/client.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace test {
+
+struct HttpResponse {
+    int status = 0;
+    std::string headers;
+    std::string body;
+};
+
+// Liest bis zum Schließen oder bis Content-Length erreicht ist; status 0 = keine Verbindung
+inline HttpResponse http_get(int port, const std::string& path, const std::string& extra_headers = "") {
+    namespace asio = websocketpp::lib::asio;
+    HttpResponse response;
+    try {
+        asio::io_service io;
+        asio::ip::tcp::socket socket(io);
+        socket.connect(asio::ip::tcp::endpoint(asio::ip::address::from_string("127.0.0.1"), static_cast<unsigned short>(port)));
+        std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n" + extra_headers + "Connection: close\r\n\r\n";
+        asio::write(socket, asio::buffer(request));
+        std::string raw;
+        char buf[4096];
+        websocketpp::lib::asio::error_code ec;
+        for (;;) {
+            size_t n = socket.read_some(asio::buffer(buf), ec);
+            raw.append(buf, n);
+            size_t head_end = raw.find("\r\n\r\n");
+            if (head_end != std::string::npos) {
+                size_t length_at = raw.find("Content-Length: ");
+                if (length_at != std::string::npos && length_at < head_end) {
+                    size_t length = std::stoul(raw.substr(length_at + 16));
+                    if (raw.size() >= head_end + 4 + length) break;
+                }
+            }
+            if (ec) break;
+        }
+        size_t head_end = raw.find("\r\n\r\n");
+        if (raw.compare(0, 9, "HTTP/1.1 ") == 0) response.status = std::stoi(raw.substr(9, 3));
+        response.headers = raw.substr(0, head_end);
+        if (head_end != std::string::npos) response.body = raw.substr(head_end + 4);
+    } catch (const std::exception&) {
+        response.status = 0;
+    }
+    return response;
+}
+
+class WsClient {
+public:
+    using client_t = websocketpp::client<websocketpp::config::asio_client>;
+
+    WsClient() {
+        m_client.clear_access_channels(websocketpp::log::alevel::all);
+        m_client.clear_error_channels(websocketpp::log::elevel::all);
+        m_client.init_asio();
+        m_client.set_open_handler([this](websocketpp::connection_hdl) { m_open = true; });
+        m_client.set_fail_handler([this](websocketpp::connection_hdl hdl) {
+            m_failed = true;
+            m_close_code = m_client.get_con_from_hdl(hdl)->get_response().get_status_code();
+        });
+        m_client.set_close_handler([this](websocketpp::connection_hdl hdl) {
+            m_closed = true;
+            m_close_code = m_client.get_con_from_hdl(hdl)->get_remote_close_code();
+        });
+        m_client.set_message_handler([this](websocketpp::connection_hdl, client_t::message_ptr msg) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_messages.push_back(msg->get_payload());
+        });
+    }
+
+    ~WsClient() { stop(); }
+
+    // Verbindet und wartet bis zu timeout auf open oder fail
+    bool connect(int port, const std::string& resource = "/", std::chrono::milliseconds timeout = std::chrono::seconds(2)) {
+        websocketpp::lib::error_code ec;
+        m_connection = m_client.get_connection("ws://127.0.0.1:" + std::to_string(port) + resource, ec);
+        if (ec) return false;
+        m_client.connect(m_connection);
+        m_thread = std::thread([this] { m_client.run(); });
+        auto until = std::chrono::steady_clock::now() + timeout;
+        while (!m_open && !m_failed && std::chrono::steady_clock::now() < until) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        return m_open;
+    }
+
+    void send(const std::string& text) {
+        websocketpp::lib::error_code ec;
+        m_client.send(m_connection->get_handle(), text, websocketpp::frame::opcode::text, ec);
+    }
+
+    void close() {
+        websocketpp::lib::error_code ec;
+        if (m_open && !m_closed) m_client.close(m_connection->get_handle(), websocketpp::close::status::normal, "", ec);
+    }
+
+    void stop() {
+        if (!m_thread.joinable()) return;
+        close();
+        m_client.stop();
+        m_thread.join();
+    }
+
+    std::vector<std::string> messages() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_messages;
+    }
+
+    size_t message_count() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_messages.size();
+    }
+
+    // Wartet, bis pred für die bisherigen Nachrichten gilt
+    bool wait_for(const std::function<bool(const std::vector<std::string>&)>& pred,
+                  std::chrono::milliseconds timeout = std::chrono::seconds(2)) {
+        auto until = std::chrono::steady_clock::now() + timeout;
+        do {
+            if (pred(messages())) return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        } while (std::chrono::steady_clock::now() < until);
+        return false;
+    }
+
+    bool is_open() const { return m_open && !m_closed; }
+    bool failed() const { return m_failed; }
+    bool closed() const { return m_closed; }
+    int close_code() const { return m_close_code; }
+
+private:
+    client_t m_client;
+    client_t::connection_ptr m_connection;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::vector<std::string> m_messages;
+    std::atomic<bool> m_open{false};
+    std::atomic<bool> m_failed{false};
+    std::atomic<bool> m_closed{false};
+    std::atomic<int> m_close_code{0};
+};
+
+// WebSocket-Handshake über ein rohes Socket, danach wird nie gelesen:
+// der Server sieht einen Client, der nicht hinterherkommt
+class StalledClient {
+public:
+    bool connect(int port, const std::string& resource = "/") {
+        namespace asio = websocketpp::lib::asio;
+        try {
+            m_socket.connect(asio::ip::tcp::endpoint(asio::ip::address::from_string("127.0.0.1"), static_cast<unsigned short>(port)));
+            m_socket.set_option(asio::socket_base::receive_buffer_size(4096));
+            std::string request = "GET " + resource + " HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\n"
+                                  "Connection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                                  "Sec-WebSocket-Version: 13\r\n\r\n";
+            asio::write(m_socket, asio::buffer(request));
+            std::string head;
+            char c;
+            while (head.find("\r\n\r\n") == std::string::npos) {
+                asio::read(m_socket, asio::buffer(&c, 1));
+                head += c;
+            }
+            return head.compare(0, 12, "HTTP/1.1 101") == 0;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    // true, sobald der Server die Verbindung geschlossen hat (liest dabei alles Wartende)
+    bool closed_by_server() {
+        namespace asio = websocketpp::lib::asio;
+        m_socket.non_blocking(true);
+        char buf[65536];
+        for (;;) {
+            websocketpp::lib::asio::error_code ec;
+            m_socket.read_some(asio::buffer(buf), ec);
+            if (ec == asio::error::would_block) return false;
+            if (ec) return true;
+        }
+    }
+
+private:
+    websocketpp::lib::asio::io_service m_io;
+    websocketpp::lib::asio::ip::tcp::socket m_socket{m_io};
+};
+
+} // namespace test
@@ -0,0 +1,162 @@
+#include "test_support.hpp"
+#include "test_client.hpp"
+#include "event_journal.hpp"
+#include "websocket_server.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<uint64_t> seqs(const std::vector<EncodedFramePtr>& events) {
+    std::vector<uint64_t> out;
+    for (const auto& event : events) out.push_back(event->seq);
+    return out;
+}
+
+// Erste Nachricht vom Typ replay
+nlohmann::json replay_header(const std::vector<std::string>& messages) {
+    for (const auto& msg : messages) {
+        nlohmann::json j = nlohmann::json::parse(msg, nullptr, false);
+        if (j.is_object() && j.value("type", "") == "replay") return j;
+    }
+    return nlohmann::json();
+}
+
+// Nachrichten, die mit {"seq":N beginnen
+size_t count_seq(const std::vector<std::string>& messages, uint64_t seq) {
+    const std::string needle = "{\"seq\":" + std::to_string(seq);
+    size_t count = 0;
+    for (const auto& msg : messages) {
+        if (msg.compare(0, needle.size(), needle) == 0 && msg.size() > needle.size() &&
+            (msg[needle.size()] == ',' || msg[needle.size()] == '}')) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool has_seq(const std::vector<std::string>& messages, uint64_t seq) {
+    return count_seq(messages, seq) > 0;
+}
+
+} // namespace
+
+TEST_CASE(journal_since_returns_newer_events) {
+    EventJournal journal;
+    journal.open(8, "");
+    for (uint64_t seq = 1; seq <= 5; ++seq) journal.append(*test::make_frame(seq * 2, MessageKind::gameplay));
+    journal.note_seq(11);
+
+    std::vector<EncodedFramePtr> events;
+    EventJournal::Replay replay = journal.since(4, events);
+    CHECK((seqs(events) == std::vector<uint64_t>{6, 8, 10}));
+    CHECK(replay.complete);
+    CHECK(!replay.reset);
+    CHECK(replay.until == 10);
+
+    // Ein Frame nach dem letzten Ereignis ist kein Vorgriff
+    events.clear();
+    replay = journal.since(11, events);
+    CHECK(events.empty());
+    CHECK(replay.complete);
+    CHECK(!replay.reset);
+    CHECK(replay.until == 10);
+}
+
+TEST_CASE(journal_reports_evicted_events) {
+    EventJournal journal;
+    journal.open(3, "");
+    for (uint64_t seq = 1; seq <= 6; ++seq) journal.append(*test::make_frame(seq, MessageKind::gameplay));
+
+    std::vector<EncodedFramePtr> events;
+    EventJournal::Replay replay = journal.since(1, events);
+    CHECK((seqs(events) == std::vector<uint64_t>{4, 5, 6}));
+    CHECK(!replay.complete);
+
+    // seq 3 ist verdrängt, aber der Client hatte es schon
+    events.clear();
+    CHECK(journal.since(3, events).complete);
+}
+
+// seq aus einer früheren Sitzung: das ganze Journal, und until bleibt beim neuesten Eintrag
+TEST_CASE(journal_since_ahead_resets) {
+    EventJournal journal;
+    journal.open(8, "");
+    for (uint64_t seq = 1; seq <= 3; ++seq) journal.append(*test::make_frame(seq, MessageKind::gameplay));
+
+    std::vector<EncodedFramePtr> events;
+    EventJournal::Replay replay = journal.since(500, events);
+    CHECK(replay.reset);
+    CHECK(replay.complete);
+    CHECK((seqs(events) == std::vector<uint64_t>{1, 2, 3}));
+    CHECK(replay.until == 3);
+
+    // Auch leer ist ein unbekanntes seq ein Vorgriff
+    EventJournal empty;
+    empty.open(8, "");
+    events.clear();
+    replay = empty.since(7, events);
+    CHECK(replay.reset);
+    CHECK(events.empty());
+    CHECK(replay.until == 0);
+}
+
+TEST_CASE(journal_disabled_keeps_nothing) {
+    EventJournal journal;
+    journal.open(0, "");
+    CHECK(!journal.enabled());
+    journal.append(*test::make_frame(1, MessageKind::gameplay));
+    std::vector<EncodedFramePtr> events;
+    journal.since(0, events);
+    CHECK(events.empty());
+}
+
+// Nachlieferung über den Server: bekanntes seq, und ein seq vor dem Server (Neustart
+// des Spiels). Im zweiten Fall müssen spätere Ereignisse trotzdem live ankommen.
+TEST_CASE(replay_since_over_websocket) {
+    PluginConfig cfg;
+    cfg.port = test::next_port();
+    cfg.ws_threads = 2;
+    cfg.journal_size = 16;
+    WebSocketServer server;
+    REQUIRE(server.start(cfg));
+
+    test::WsClient first;
+    REQUIRE(first.connect(cfg.port));
+    for (uint64_t seq = 1; seq <= 5; ++seq) server.queue_broadcast(test::make_frame(seq, MessageKind::gameplay));
+    server.queue_broadcast(test::make_frame(6, MessageKind::frame, "", "", true));
+    REQUIRE(first.wait_for([](const std::vector<std::string>& m) { return has_seq(m, 6); }));
+
+    test::WsClient behind;
+    REQUIRE(behind.connect(cfg.port, "/?since=3"));
+    test::WsClient ahead;
+    REQUIRE(ahead.connect(cfg.port, "/?since=100"));
+    CHECK(behind.wait_for([](const std::vector<std::string>& m) { return has_seq(m, 5); }));
+    CHECK(ahead.wait_for([](const std::vector<std::string>& m) { return has_seq(m, 5); }));
+
+    nlohmann::json header = replay_header(behind.messages());
+    CHECK(header.value("count", 0) == 2);
+    CHECK(header.value("complete", false));
+    CHECK(!header.value("reset", true));
+    CHECK(!has_seq(behind.messages(), 3));
+
+    header = replay_header(ahead.messages());
+    CHECK(header.value("count", 0) == 5);
+    CHECK(header.value("reset", false));
+
+    server.queue_broadcast(test::make_frame(7, MessageKind::gameplay));
+    CHECK(behind.wait_for([](const std::vector<std::string>& m) { return has_seq(m, 7); }));
+    CHECK(ahead.wait_for([](const std::vector<std::string>& m) { return has_seq(m, 7); }));
+
+    // Jedes Ereignis genau einmal (seq 6 war ein Frame)
+    for (uint64_t seq : {4, 5, 7}) CHECK(count_seq(ahead.messages(), seq) == 1);
+
+    first.stop();
+    behind.stop();
+    ahead.stop();
+    server.stop();
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "test_support.hpp"
+#include "frame_budget.hpp"
+#include "plugin_metrics.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+constexpr auto frame_time = std::chrono::microseconds(16667);
+
+// Ein veröffentlichter Frame mit der angegebenen Arbeitszeit; die Uhr läuft um einen Frame weiter
+void publish(FrameBudget& budget, Clock::time_point& now, uint64_t work_us) {
+    now += frame_time;
+    budget.record(work_us * 1000, now);
+}
+
+// Wie viele von n Frames würden veröffentlicht?
+int published_of(FrameBudget& budget, int n) {
+    int published = 0;
+    for (int i = 0; i < n; ++i) published += budget.should_publish() ? 1 : 0;
+    return published;
+}
+
+} // namespace
+
+TEST_CASE(frame_budget_steps_up_and_back) {
+    FrameBudget budget;
+    Clock::time_point now{};
+    budget.configure(500, now);
+    CHECK(budget.level() == 0);
+    CHECK(published_of(budget, 8) == 8);
+
+    // Ein Viertel der Frames über dem Budget reicht für die nächste Stufe
+    for (uint32_t i = 0; i < FrameBudget::window_frames; ++i) publish(budget, now, i % 4 == 0 ? 900 : 100);
+    CHECK(budget.level() == 1);
+    CHECK(g_metrics.frame_budget_level.load() == 1);
+    CHECK(published_of(budget, 8) == 4);
+
+    // Knapp darunter bleibt es dabei
+    for (uint32_t i = 0; i < FrameBudget::window_frames; ++i) publish(budget, now, i < FrameBudget::window_limit - 1 ? 900 : 100);
+    CHECK(budget.level() == 1);
+
+    // Dauerhaft drüber: bis zur höchsten Stufe, nicht weiter
+    for (int w = 0; w < 5; ++w) {
+        for (uint32_t i = 0; i < FrameBudget::window_frames; ++i) publish(budget, now, 2000);
+    }
+    CHECK(budget.level() == FrameBudget::max_level);
+    CHECK(published_of(budget, 16) == 2);
+
+    // Wieder im Budget: erst nach calm_time eine Stufe zurück, dann die nächste
+    const auto calm_frames = static_cast<int>(FrameBudget::calm_time / frame_time);
+    for (int i = 0; i < calm_frames - 1; ++i) publish(budget, now, 100);
+    CHECK(budget.level() == FrameBudget::max_level);
+    publish(budget, now, 100);
+    publish(budget, now, 100);
+    CHECK(budget.level() == FrameBudget::max_level - 1);
+    for (uint32_t level = FrameBudget::max_level - 1; level > 0; --level) {
+        for (int i = 0; i <= calm_frames; ++i) publish(budget, now, 100);
+    }
+    CHECK(budget.level() == 0);
+    CHECK(g_metrics.frame_budget_level.load() == 0);
+    CHECK(published_of(budget, 8) == 8);
+
+    // Eine einzelne Überschreitung startet die Ruhezeit neu
+    for (int w = 0; w < 2; ++w) {
+        for (uint32_t i = 0; i < FrameBudget::window_frames; ++i) publish(budget, now, 2000);
+    }
+    CHECK(budget.level() == 2);
+    for (int i = 0; i < calm_frames - 10; ++i) publish(budget, now, 100);
+    publish(budget, now, 2000);
+    for (int i = 0; i < calm_frames - 10; ++i) publish(budget, now, 100);
+    CHECK(budget.level() == 2);
+}
+
+TEST_CASE(frame_budget_disabled) {
+    FrameBudget budget;
+    Clock::time_point now{};
+    budget.configure(0, now);
+    for (int i = 0; i < 600; ++i) publish(budget, now, 100000);
+    CHECK(budget.level() == 0);
+    CHECK(published_of(budget, 8) == 8);
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "test_support.hpp"
+#include "frame_encoder.hpp"
+#include "frame_pool.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Ein Ausschnitt des Telemetrie-Zustands, wie ihn plugin.cpp an encode_fields übergibt
+struct State {
+    std::map<std::string, nlohmann::json> values;
+    std::vector<const FrameEncoder::Field*> fields;
+
+    State() {
+        values["truck.speed"] = 22.5;
+        values["truck.engine.rpm"] = 1450.0;
+        values["truck.cruise_control"] = false;
+        values["truck.gear"] = 7;
+        values["truck.world.placement"] = {{"x", 1.0}, {"y", 2.0}, {"z", 3.0}};
+        values["trailer.wheels.rotation"] = {0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0, 1.1, 1.2, 1.3, 1.4, 1.5, 1.6, 1.7, 1.8};
+        values["truck.brand"] = "scania";
+        values["game.time"] = 123456;
+        for (const auto& entry : values) fields.push_back(&entry);
+    }
+
+    void step(int i) {
+        values["truck.speed"] = 22.5 + i * 0.01;
+        values["truck.engine.rpm"] = 1450.0 + i;
+        values["truck.gear"] = i % 12;
+        values["truck.world.placement"]["x"] = 1.0 + i;
+        values["game.time"] = 123456 + i;
+    }
+};
+
+} // namespace
+
+// Nach dem Einschwingen allokieren Pool und Encoder pro Frame nichts mehr,
+// auch wenn die Ausgänge die letzten Frames noch festhalten
+TEST_CASE(frame_encoder_steady_state_allocates_nothing) {
+    FramePool pool(64);
+    FrameEncoder encoder;
+    State state;
+    const std::string game = "eut2";
+    nlohmann::json event = {{"type", "gameplay"}, {"event", "job.delivered"}, {"attributes", {{"revenue", 12345}, {"cargo", "wood"}}}};
+
+    // Die letzten 16 Frames sind noch "unterwegs" (Queue, Sende-Queues)
+    std::vector<std::shared_ptr<EncodedFrame>> in_flight(16);
+    uint64_t allocations = 0;
+    auto run = [&](int from, int to) {
+        for (int i = from; i < to; ++i) {
+            state.step(i); // allokiert selbst (Schlüssel als std::string), zählt nicht mit
+            const uint64_t before = test::thread_allocations();
+            std::shared_ptr<EncodedFrame> frame = pool.acquire();
+            frame->seq = static_cast<uint64_t>(i);
+            if (i % 50 == 0) {
+                encoder.encode(event, true, *frame);
+            } else {
+                encoder.encode_fields(state.fields.data(), state.fields.size(), 1700000000 + i, game, true, *frame);
+            }
+            pool.note_size(frame->json.size());
+            in_flight[static_cast<size_t>(i) % in_flight.size()] = std::move(frame);
+            allocations += test::thread_allocations() - before;
+        }
+    };
+
+    run(0, 200);
+    allocations = 0;
+    run(200, 10200);
+    CHECK(allocations == 0);
+    CHECK(pool.misses() == 0);
+    CHECK(pool.pooled() <= 17);
+
+    const EncodedFrame& last = *in_flight[10199 % in_flight.size()];
+    nlohmann::json decoded = nlohmann::json::parse(last.json.begin(), last.json.end());
+    CHECK(decoded["seq"] == 10199);
+    CHECK(decoded["game"] == "eut2");
+    CHECK(decoded["truck.gear"] == 10199 % 12);
+    CHECK(nlohmann::json::from_msgpack(last.msgpack.begin(), last.msgpack.end()) == decoded);
+}
+
+// MessagePack und JSON beschreiben dieselbe Nachricht, auch mit verschachtelten Objekten und Arrays
+TEST_CASE(frame_encoder_msgpack_matches_json) {
+    FrameEncoder encoder;
+    EncodedFrame frame;
+    frame.seq = 42;
+    nlohmann::json message = {{"type", "config"},
+                              {"id", "trailer.0"},
+                              {"attributes", {{"wheel.positions", nlohmann::json::array({{{"x", 1.5}}, {{"x", -1.5}}})},
+                                              {"wheel.count", 20},
+                                              {"empty", nlohmann::json::object()}}}};
+    encoder.encode(message, true, frame);
+    nlohmann::json expected = message;
+    expected["seq"] = 42;
+    CHECK(nlohmann::json::parse(frame.json.begin(), frame.json.end()) == expected);
+    CHECK(nlohmann::json::from_msgpack(frame.msgpack.begin(), frame.msgpack.end()) == expected);
+}
@@ -0,0 +1,100 @@
+#include "test_support.hpp"
+#include "frame_queue.hpp"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Jedes zehnte Element ist ein Ereignis
+std::vector<EncodedFramePtr> make_messages(size_t count) {
+    std::vector<EncodedFramePtr> messages;
+    for (size_t i = 0; i < count; ++i) {
+        messages.push_back(test::make_frame(i + 1, i % 10 == 0 ? MessageKind::gameplay : MessageKind::frame));
+    }
+    return messages;
+}
+
+} // namespace
+
+TEST_CASE(frame_queue_keeps_order) {
+    FrameQueue queue(16, FrameQueue::Overflow::drop_oldest);
+    for (uint64_t seq = 1; seq <= 10; ++seq) queue.push(test::make_frame(seq));
+    std::vector<EncodedFramePtr> out;
+    queue.drain(out);
+    REQUIRE(out.size() == 10);
+    for (size_t i = 0; i < out.size(); ++i) CHECK(out[i]->seq == i + 1);
+    CHECK(queue.frames_dropped() == 0);
+}
+
+// Volle Queue: Frames werden verworfen, Ereignisse nie, und alles kommt nach seq sortiert an.
+// Solange der Knotenvorrat reicht (so viele Knoten wie Zellen), allokiert push() nicht.
+TEST_CASE(frame_queue_overflow_keeps_events_in_order) {
+    for (FrameQueue::Overflow policy : {FrameQueue::Overflow::drop_oldest, FrameQueue::Overflow::drop_newest}) {
+        FrameQueue queue(16, policy);
+        std::vector<EncodedFramePtr> messages = make_messages(200);
+        uint64_t before = test::thread_allocations();
+        for (const auto& m : messages) queue.push(m);
+        CHECK(test::thread_allocations() - before == queue.overflow_nodes_allocated());
+        std::vector<EncodedFramePtr> out;
+        queue.drain(out);
+
+        size_t events = 0;
+        for (size_t i = 0; i < out.size(); ++i) {
+            if (i > 0) CHECK(out[i - 1]->seq < out[i]->seq);
+            if (out[i]->kind == MessageKind::gameplay) ++events;
+        }
+        CHECK(events == 20);
+        CHECK(queue.frames_dropped() + out.size() == messages.size());
+        REQUIRE(queue.events_overflowed() > 16);
+        CHECK(queue.overflow_nodes_allocated() == queue.events_overflowed() - 16); // Vorrat: 16 Knoten
+    }
+
+    // Nach drain() sind die Knoten wieder frei
+    FrameQueue queue(32, FrameQueue::Overflow::drop_oldest);
+    for (int round = 0; round < 3; ++round) {
+        for (const auto& m : make_messages(300)) queue.push(m);
+        std::vector<EncodedFramePtr> out;
+        queue.drain(out);
+        CHECK(out.size() == 32 + 30 - 3); // voller Ring und die 30 Ereignisse, 3 davon noch im Ring
+    }
+    CHECK(queue.overflow_nodes_allocated() == 0);
+}
+
+// Erzeuger-Thread gegen laufendes drain(): über alle Stapel hinweg steigt seq streng,
+// kein Ereignis fehlt, und push() allokiert nur, wenn der Knotenvorrat erschöpft ist
+TEST_CASE(frame_queue_concurrent_order_across_drains) {
+    FrameQueue queue(16, FrameQueue::Overflow::drop_oldest);
+    std::vector<EncodedFramePtr> messages = make_messages(200000);
+    std::atomic<bool> done{false};
+    uint64_t producer_allocations = 0;
+    std::thread producer([&] {
+        uint64_t before = test::thread_allocations();
+        for (const auto& m : messages) queue.push(m);
+        producer_allocations = test::thread_allocations() - before;
+        done = true;
+    });
+
+    uint64_t last_seq = 0;
+    size_t events = 0;
+    size_t order_errors = 0;
+    std::vector<EncodedFramePtr> batch;
+    for (;;) {
+        bool finished = done.load();
+        batch.clear();
+        queue.drain(batch);
+        for (const auto& m : batch) {
+            if (m->seq <= last_seq) ++order_errors;
+            last_seq = m->seq;
+            if (m->kind == MessageKind::gameplay) ++events;
+        }
+        if (finished && batch.empty()) break;
+    }
+    producer.join();
+
+    CHECK(order_errors == 0);
+    CHECK(events == messages.size() / 10);
+    CHECK(producer_allocations == queue.overflow_nodes_allocated());
+}
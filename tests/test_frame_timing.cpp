@@ -0,0 +1,43 @@
+#include "test_support.hpp"
+#include "frame_timing.hpp"
+
+#include <cmath>
+#include <cstdint>
+
+// 60 Hz aus frame_start, dann zwei Sekunden Pause und ein Sprung in eine neue Sitzung
+TEST_CASE(frame_timing_measures_rate_and_pauses) {
+    FrameTiming timing;
+    const uint64_t step = 16667;
+    uint64_t render = 5000000;
+    uint64_t simulation = render;
+    uint64_t paused_simulation = 1000000;
+    auto frame = [&](bool simulate, bool paused) {
+        render += step;
+        if (simulate) simulation += step;
+        if (simulate && !paused) paused_simulation += step;
+        timing.on_frame_start(false, render, simulation, paused_simulation);
+    };
+
+    timing.on_frame_start(true, render, simulation, paused_simulation);
+    for (int i = 0; i < 61; ++i) frame(true, false);
+    CHECK(std::fabs(g_frame_timing.fps.load() - 60.0) < 0.5);
+    CHECK(std::fabs(g_frame_timing.frame_interval_ms.load() - 16.667) < 0.01);
+    CHECK(std::fabs(g_frame_timing.simulation_step_ms.load() - 16.667) < 0.01);
+    CHECK(!g_frame_timing.paused.load());
+
+    // Zwei Sekunden Pause: die Simulation läuft weiter, die pausierbare Zeit steht
+    const uint64_t pauses_before = g_frame_timing.pauses.load();
+    for (int i = 0; i < 120; ++i) frame(true, true);
+    CHECK(g_frame_timing.paused.load());
+    frame(true, false);
+    CHECK(!g_frame_timing.paused.load());
+    CHECK(g_frame_timing.pauses.load() == pauses_before + 1);
+    CHECK(std::fabs(g_frame_timing.last_pause_s.load() - 121 * step / 1e6) < 0.001);
+
+    // Zeitsprung rückwärts (neue Sitzung) beginnt ohne Pause und ohne Schritt neu
+    render = 1000;
+    simulation = 1000;
+    paused_simulation = 1000;
+    timing.on_frame_start(false, render, simulation, paused_simulation);
+    CHECK(!g_frame_timing.paused.load());
+}
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include "test_support.hpp"
+#include "test_client.hpp"
+#include "websocket_server.hpp"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Wartet, bis /metrics genau clients Verbindungen meldet
+bool wait_for_clients(int port, int clients, std::chrono::milliseconds timeout = std::chrono::seconds(2)) {
+    const std::string gauge = "\nscs_ws_clients " + std::to_string(clients) + "\n";
+    auto until = std::chrono::steady_clock::now() + timeout;
+    do {
+        if (test::http_get(port, "/metrics").body.find(gauge) != std::string::npos) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    } while (std::chrono::steady_clock::now() < until);
+    return false;
+}
+
+// Sendet 2,5 s lang 4-KB-Ereignisse mit 1 kHz; die ersten MB landen noch in den
+// Socket-Puffern des Kernels. Wer nicht liest, bekommt das Close nie zu sehen;
+// websocketpp trennt ihn erst nach dem Close-Timeout (5 s).
+void broadcast_events(WebSocketServer& server) {
+    for (uint64_t seq = 1; seq <= 2500; ++seq) {
+        // Ereignisse statt Frames: die werden nie verworfen, der Puffer wächst also wirklich
+        server.queue_broadcast(test::make_frame(seq, MessageKind::gameplay, test::sized_json(seq, 4096)));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+} // namespace
+
+// Gleichzeitige Handshakes auf mehreren Shards dürfen max_connections nicht gemeinsam überschreiten
+TEST_CASE(max_connections_holds_under_concurrent_handshakes) {
+    PluginConfig cfg;
+    cfg.port = test::next_port();
+    cfg.ws_threads = 3;
+    cfg.max_connections = 3;
+    WebSocketServer server;
+    REQUIRE(server.start(cfg));
+
+    std::vector<std::unique_ptr<test::WsClient>> clients;
+    for (int i = 0; i < 12; ++i) clients.emplace_back(new test::WsClient());
+    std::vector<std::thread> connectors;
+    for (auto& client : clients) {
+        test::WsClient* c = client.get();
+        connectors.emplace_back([c, &cfg] { c->connect(cfg.port); });
+    }
+    for (auto& t : connectors) t.join();
+
+    int open = 0;
+    int rejected = 0;
+    for (auto& client : clients) {
+        if (client->is_open()) ++open;
+        if (client->failed() && client->close_code() == 503) ++rejected;
+    }
+    CHECK(open == 3);
+    CHECK(rejected == 9);
+    CHECK(wait_for_clients(cfg.port, 3));
+
+    // SSE zählt mit und wird ebenso abgewiesen
+    CHECK(test::http_get(cfg.port, "/events").status == 503);
+
+    // Abgewiesene und geschlossene Verbindungen geben ihren Platz frei
+    for (auto& client : clients) {
+        if (client->is_open()) {
+            client.reset(); // erst der Destruktor schließt das Socket sicher
+            break;
+        }
+    }
+    CHECK(wait_for_clients(cfg.port, 2));
+    {
+        test::WsClient late;
+        CHECK(late.connect(cfg.port));
+        CHECK(wait_for_clients(cfg.port, 3));
+    }
+    clients.clear();
+    CHECK(wait_for_clients(cfg.port, 0));
+    server.stop();
+}
+
+// Ein Client, der nicht liest, wird über max_connection_buffer_kb getrennt; der andere bleibt
+TEST_CASE(connection_buffer_limit_closes_stalled_client) {
+    PluginConfig cfg;
+    cfg.port = test::next_port();
+    cfg.ws_threads = 2;
+    cfg.max_connection_buffer_kb = 256;
+    cfg.max_total_buffer_kb = 0;
+    cfg.buffer_limit_policy = "disconnect";
+    WebSocketServer server;
+    REQUIRE(server.start(cfg));
+
+    test::WsClient healthy;
+    REQUIRE(healthy.connect(cfg.port));
+    test::StalledClient stalled;
+    REQUIRE(stalled.connect(cfg.port));
+    REQUIRE(wait_for_clients(cfg.port, 2));
+
+    broadcast_events(server);
+    CHECK(wait_for_clients(cfg.port, 1, std::chrono::seconds(8)));
+    CHECK(healthy.is_open());
+    CHECK(healthy.wait_for([](const std::vector<std::string>& m) { return m.size() > 2500; }));
+
+    healthy.stop();
+    server.stop();
+}
+
+// Über max_total_buffer_kb wird die größte Warteschlange getrennt, bis die Summe passt
+TEST_CASE(total_buffer_limit_closes_largest_clients) {
+    PluginConfig cfg;
+    cfg.port = test::next_port();
+    cfg.ws_threads = 2;
+    cfg.max_connection_buffer_kb = 0;
+    cfg.max_total_buffer_kb = 512;
+    cfg.buffer_limit_policy = "disconnect";
+    WebSocketServer server;
+    REQUIRE(server.start(cfg));
+
+    test::WsClient healthy;
+    REQUIRE(healthy.connect(cfg.port));
+    test::StalledClient stalled_a;
+    REQUIRE(stalled_a.connect(cfg.port));
+    test::StalledClient stalled_b;
+    REQUIRE(stalled_b.connect(cfg.port));
+    REQUIRE(wait_for_clients(cfg.port, 3));
+
+    broadcast_events(server);
+    CHECK(wait_for_clients(cfg.port, 1, std::chrono::seconds(8)));
+    CHECK(healthy.is_open());
+    CHECK(healthy.wait_for([](const std::vector<std::string>& m) { return m.size() > 2500; }));
+
+    healthy.stop();
+    server.stop();
+}
+
+// Ist der Port belegt, schlägt start() fehl und hinterlässt nichts, was am io_service der abgebauten Shards hängt
+TEST_CASE(start_on_busy_port_fails_cleanly) {
+    PluginConfig cfg;
+    cfg.port = test::next_port();
+    cfg.ws_threads = 2;
+    WebSocketServer first;
+    REQUIRE(first.start(cfg));
+    {
+        WebSocketServer second;
+        CHECK(!second.start(cfg));
+        CHECK(!second.is_running());
+        CHECK(!second.start(cfg)); // zweiter Versuch mit demselben Objekt
+    }
+
+    // Nach dem Fehlschlag startet dasselbe Objekt auf einem freien Port
+    WebSocketServer retry;
+    CHECK(!retry.start(cfg));
+    PluginConfig free_cfg = cfg;
+    free_cfg.port = test::next_port();
+    REQUIRE(retry.start(free_cfg));
+    {
+        test::WsClient client;
+        CHECK(client.connect(free_cfg.port));
+    }
+    retry.stop();
+
+    // Der erste Server nimmt weiter Verbindungen an
+    {
+        test::WsClient client;
+        CHECK(client.connect(cfg.port));
+    }
+    first.stop();
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "test_support.hpp"
+#include "log_format.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace {
+
+// Packt Argumente so, wie es plugin_log.cpp im Binärformat tut
+struct Args {
+    std::string bytes;
+
+    template <typename T>
+    Args& put(binlog::ArgType type, T value) {
+        bytes += static_cast<char>(type);
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        return *this;
+    }
+    Args& i(int64_t v) { return put(binlog::arg_int, v); }
+    Args& u(uint64_t v) { return put(binlog::arg_uint, v); }
+    Args& f(double v) { return put(binlog::arg_double, v); }
+    Args& s(const std::string& v) {
+        put(binlog::arg_string, static_cast<uint16_t>(v.size()));
+        bytes += v;
+        return *this;
+    }
+};
+
+std::string format(const char* fmt, const Args& args) {
+    std::string out;
+    binlog::format_args(fmt, args.bytes.data(), args.bytes.size(), out);
+    return out;
+}
+
+} // namespace
+
+TEST_CASE(log_format_parses_specs) {
+    const char* fmt = "%-5d|%05.2f|%lld|%zu|%hhx|%*s|%%|%Lf";
+    size_t pos = 0;
+    binlog::Spec spec;
+    std::string conversions;
+    std::string lengths;
+    int stars = 0;
+    while (binlog::next_spec(fmt, pos, spec)) {
+        conversions += spec.conversion;
+        lengths += spec.length ? spec.length : '-';
+        stars += spec.stars;
+    }
+    CHECK(conversions == "dfduxs%f");
+    CHECK(lengths == "--LzH--D");
+    CHECK(stars == 1);
+}
+
+TEST_CASE(log_format_round_trips_arguments) {
+    CHECK(format("Client connected (shard %zu). Clients on shard: %d", Args().u(2).i(-7)) ==
+          "Client connected (shard 2). Clients on shard: -7");
+    CHECK(format("%.1f ms, %s, 100%%", Args().f(12.25).s("ok")) == "12.2 ms, ok, 100%");
+    CHECK(format("[%5s] %-3u|%x", Args().s("ab").u(4).u(255)) == "[   ab] 4  |ff");
+    CHECK(format("%*d", Args().i(4).i(7)) == "   7");
+    CHECK(format("%c%c", Args().u('o').u('k')) == "ok");
+}
+
+// Abgeschnittene oder nicht passende Argumente werden nicht geraten
+TEST_CASE(log_format_marks_missing_arguments) {
+    CHECK(format("a=%d b=%d", Args().i(1)) == "a=1 b=<?>");
+    CHECK(format("a=%d b=%s", Args().u(1).s("x")) == "a=<?> b=<?>");
+    Args cut = Args().s("abcdef");
+    cut.bytes.resize(cut.bytes.size() - 2);
+    CHECK(format("%s!", cut) == "<?>!");
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "test_support.hpp"
+#include "plugin_log.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <new>
+
+// Alle Allokationen des Testprogramms laufen hier durch; gezählt wird pro Thread
+static thread_local uint64_t t_allocations = 0;
+
+void* operator new(std::size_t size) {
+    ++t_allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) {
+    ++t_allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace test {
+
+std::vector<Case>& registry() {
+    static std::vector<Case> cases;
+    return cases;
+}
+
+int failures = 0;
+
+uint64_t thread_allocations() {
+    return t_allocations;
+}
+
+int next_port() {
+    static int port = 19700 + static_cast<int>(std::chrono::steady_clock::now().time_since_epoch().count() % 200) * 10;
+    return port++;
+}
+
+} // namespace test
+
+int main(int argc, char** argv) {
+    plugin_log_init("scs_ws_tests.log");
+    int failed_cases = 0;
+    int run = 0;
+    for (const test::Case& c : test::registry()) {
+        if (argc > 1 && std::strstr(c.name, argv[1]) == nullptr) continue;
+        ++run;
+        test::failures = 0;
+        auto start = std::chrono::steady_clock::now();
+        try {
+            c.run();
+        } catch (const test::Abort&) {
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "%s: exception: %s\n", c.name, e.what());
+            ++test::failures;
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-40s %s (%.0f ms)\n", c.name, test::failures ? "FAILED" : "ok", ms);
+        if (test::failures) ++failed_cases;
+    }
+    plugin_log_close();
+    std::printf("%d of %d test cases failed\n", failed_cases, run);
+    return failed_cases == 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+#include "test_support.hpp"
+#include "test_client.hpp"
+#include "latency_stats.hpp"
+#include "websocket_server.hpp"
+
+#include <memory>
+#include <thread>
+
+// GET /metrics liefert die verlangten Reihen im Prometheus-Textformat
+TEST_CASE(metrics_endpoint_serves_counters) {
+    PluginConfig cfg;
+    cfg.port = test::next_port();
+    cfg.ws_threads = 2;
+    WebSocketServer server;
+    REQUIRE(server.start(cfg));
+
+    test::WsClient client;
+    REQUIRE(client.connect(cfg.port));
+    for (uint64_t seq = 1; seq <= 20; ++seq) server.queue_broadcast(test::make_frame(seq, MessageKind::frame, "", "", true));
+    CHECK(client.wait_for([](const std::vector<std::string>& m) { return m.size() >= 21; })); // welcome + 20
+
+    test::HttpResponse response = test::http_get(cfg.port, "/metrics");
+    CHECK(response.status == 200);
+    CHECK(response.headers.find("text/plain; version=0.0.4") != std::string::npos);
+    for (const char* series : {"scs_ws_frames_ingested_total", "scs_ws_messages_encoded_total",
+                               "scs_ws_messages_sent_total{format=\"json\"}", "scs_ws_bytes_sent_total{format=\"msgpack\"}",
+                               "scs_ws_clients 1", "scs_ws_client_buffered_bytes{client=", "scs_ws_frames_dropped_total",
+                               "scs_ws_frames_coalesced_total", "scs_ws_log_lines_dropped_total",
+                               "scs_ws_queue_frames_dropped_total"}) {
+        if (response.body.find(series) == std::string::npos) {
+            std::fprintf(stderr, "missing series %s\n", series);
+            CHECK(false);
+        }
+    }
+#if SCS_WS_LATENCY_STATS
+    CHECK(response.body.find("scs_ws_stage_latency_seconds{stage=\"client_send\",quantile=\"0.99\"}") != std::string::npos);
+#endif
+
+    client.stop();
+    server.stop();
+}
+
+#if SCS_WS_LATENCY_STATS
+// client_send zählt nur Durchläufe, die wirklich etwas an websocketpp übergeben haben
+TEST_CASE(client_send_latency_skips_empty_flushes) {
+    PluginConfig cfg;
+    cfg.port = test::next_port();
+    WebSocketServer server;
+    REQUIRE(server.start(cfg));
+
+    test::WsClient client;
+    REQUIRE(client.connect(cfg.port));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const uint64_t before = latency_summary(LatencyStage::client_send).count;
+    std::this_thread::sleep_for(std::chrono::milliseconds(300)); // ~30 leere service()-Durchläufe
+    CHECK(latency_summary(LatencyStage::client_send).count == before);
+
+    for (uint64_t seq = 1; seq <= 3; ++seq) server.queue_broadcast(test::make_frame(seq, MessageKind::frame, "", "", true));
+    CHECK(client.wait_for([](const std::vector<std::string>& m) { return m.size() >= 4; }));
+    const uint64_t sent = latency_summary(LatencyStage::client_send).count - before;
+    CHECK(sent >= 1 && sent <= 3);
+
+    client.stop();
+    server.stop();
+}
+#endif
+
+TEST_CASE(metrics_endpoint_can_be_disabled) {
+    PluginConfig cfg;
+    cfg.port = test::next_port();
+    cfg.metrics_enabled = false;
+    WebSocketServer server;
+    REQUIRE(server.start(cfg));
+    CHECK(test::http_get(cfg.port, "/metrics").status == 404);
+    server.stop();
+}
+
+
+// /clients zeigt Adressen und User-Agents, deshalb ohne clients_enabled weder per HTTP noch per Nachricht
+TEST_CASE(clients_list_is_off_by_default) {
+    PluginConfig cfg;
+    cfg.port = test::next_port();
+    WebSocketServer server;
+    REQUIRE(server.start(cfg));
+
+    test::WsClient client;
+    REQUIRE(client.connect(cfg.port));
+    CHECK(test::http_get(cfg.port, "/clients").status == 404);
+    client.send("{\"clients\":true}");
+    client.send("{\"stats\":true}");
+    CHECK(client.wait_for([](const std::vector<std::string>& m) {
+        return !m.empty() && m.back().find("\"type\":\"stats\"") != std::string::npos;
+    }));
+    for (const auto& msg : client.messages()) CHECK(msg.find("\"type\":\"clients\"") == std::string::npos);
+
+    client.stop();
+    server.stop();
+}
+
+TEST_CASE(clients_list_lists_connections_when_enabled) {
+    PluginConfig cfg;
+    cfg.port = test::next_port();
+    cfg.clients_enabled = true;
+    WebSocketServer server;
+    REQUIRE(server.start(cfg));
+
+    test::WsClient client;
+    REQUIRE(client.connect(cfg.port));
+    test::HttpResponse response = test::http_get(cfg.port, "/clients");
+    CHECK(response.status == 200);
+    CHECK(response.body.find("\"type\":\"clients\"") != std::string::npos);
+    CHECK(response.body.find("\"remote\"") != std::string::npos);
+
+    client.stop();
+    server.stop();
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "test_support.hpp"
+#include "shm_ring_reader.hpp"
+#include "shm_ring_sink.hpp"
+
+#include <memory>
+#include <string>
+
+namespace {
+
+PluginConfig ring_config(int slots) {
+    PluginConfig cfg;
+    cfg.shm_name = "scs_ws_test_ring_" + std::to_string(test::next_port());
+    cfg.shm_slots = slots;
+    cfg.shm_slot_size = 256;
+    cfg.shm_snapshot_size = 1024;
+    return cfg;
+}
+
+// Liest, bis der Ring leer ist; Überläufe werden übersprungen
+std::vector<uint64_t> read_all(ShmRingReader& reader, int* overruns = nullptr) {
+    std::vector<uint64_t> seqs;
+    std::string data;
+    uint64_t seq = 0;
+    uint32_t kind = 0;
+    for (;;) {
+        ShmRingReader::ReadResult result = reader.read_next(data, seq, kind);
+        if (result == ShmRingReader::ReadResult::empty) break;
+        if (result == ShmRingReader::ReadResult::overrun) {
+            if (overruns) ++*overruns;
+            continue;
+        }
+        if (result != ShmRingReader::ReadResult::ok) continue;
+        if (data != "{\"seq\":" + std::to_string(seq) + "}") CHECK(false);
+        seqs.push_back(seq);
+    }
+    return seqs;
+}
+
+} // namespace
+
+// Schreiben und Lesen über mehrere Runden des Rings, ohne dass der Leser zurückfällt
+TEST_CASE(shm_ring_round_trip_with_wraparound) {
+    PluginConfig cfg = ring_config(8);
+    ShmRingSink sink;
+    REQUIRE(sink.start(cfg));
+    ShmRingReader reader;
+    REQUIRE(reader.open(cfg.shm_name));
+    CHECK(reader.writer_alive());
+    CHECK(reader.format() == shm_ring::PayloadFormat::json);
+
+    uint64_t seq = 0;
+    for (int round = 0; round < 5; ++round) {
+        std::vector<uint64_t> expected;
+        for (int i = 0; i < 6; ++i) {
+            sink.write(*test::make_frame(++seq));
+            expected.push_back(seq);
+        }
+        CHECK(read_all(reader) == expected);
+    }
+    CHECK(reader.lost() == 0);
+
+    sink.stop();
+    CHECK(!reader.writer_alive());
+}
+
+// Ein zu langsamer Leser bemerkt den Überlauf, zählt die verlorenen Frames und liest danach lückenlos weiter
+TEST_CASE(shm_ring_reader_detects_overrun) {
+    PluginConfig cfg = ring_config(8);
+    ShmRingSink sink;
+    REQUIRE(sink.start(cfg));
+    ShmRingReader reader;
+    REQUIRE(reader.open(cfg.shm_name));
+
+    for (uint64_t seq = 1; seq <= 20; ++seq) sink.write(*test::make_frame(seq));
+    int overruns = 0;
+    std::vector<uint64_t> seqs = read_all(reader, &overruns);
+    CHECK(overruns == 1);
+    CHECK(reader.lost() == 12);
+    std::vector<uint64_t> expected;
+    for (uint64_t seq = 13; seq <= 20; ++seq) expected.push_back(seq);
+    CHECK(seqs == expected);
+
+    sink.write(*test::make_frame(21));
+    CHECK(read_all(reader) == std::vector<uint64_t>{21});
+    CHECK(reader.lost() == 12);
+    sink.stop();
+}
+
+// Der Snapshot hält den letzten vollständigen Zustand; reine Snapshots landen nicht im Ring
+TEST_CASE(shm_ring_snapshot) {
+    PluginConfig cfg = ring_config(8);
+    ShmRingSink sink;
+    REQUIRE(sink.start(cfg));
+    ShmRingReader reader;
+    REQUIRE(reader.open(cfg.shm_name));
+
+    std::string data;
+    uint64_t seq = 0;
+    CHECK(!reader.read_snapshot(data, seq));
+
+    sink.write(*test::make_frame(1, MessageKind::frame, "", "", true));
+    sink.write(*test::make_frame(2));
+    sink.write(*test::make_frame(3, MessageKind::snapshot, "", "", true));
+    REQUIRE(reader.read_snapshot(data, seq));
+    CHECK(seq == 3);
+    CHECK(data == "{\"seq\":3}");
+    CHECK((read_all(reader) == std::vector<uint64_t>{1, 2}));
+    sink.stop();
+}
+
+// Frames, die nicht in einen Slot passen, werden gezählt statt abgeschnitten
+TEST_CASE(shm_ring_drops_oversize_frames) {
+    PluginConfig cfg = ring_config(8);
+    ShmRingSink sink;
+    REQUIRE(sink.start(cfg));
+    ShmRingReader reader;
+    REQUIRE(reader.open(cfg.shm_name));
+
+    auto big = std::make_shared<EncodedFrame>();
+    big->seq = 1;
+    big->json.assign(static_cast<size_t>(cfg.shm_slot_size) + 1, 'x');
+    sink.write(*big);
+    sink.write(*test::make_frame(2));
+    CHECK(read_all(reader) == std::vector<uint64_t>{2});
+
+    SharedMemoryMapping mapping;
+    REQUIRE(mapping.open(cfg.shm_name));
+    auto* header = static_cast<const shm_ring::ShmRingHeader*>(mapping.data());
+    CHECK(header->oversize_dropped.load() == 1);
+    sink.stop();
+}
@@ -0,0 +1,136 @@
+#include "test_support.hpp"
+#include "accept_backoff.hpp"
+#include "stream_sink.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace asio = websocketpp::lib::asio;
+using tcp = asio::ip::tcp;
+
+namespace {
+
+// Sink auf eigenem io_service, den der Test selbst antreibt
+struct SinkFixture {
+    asio::io_service io;
+    StreamSink sink{io};
+    PluginConfig cfg;
+
+    explicit SinkFixture(const std::string& format, int max_buffer_kb = 2048) {
+        cfg.stream_tcp_port = test::next_port();
+        cfg.stream_format = format;
+        cfg.max_connection_buffer_kb = max_buffer_kb;
+    }
+
+    void poll_for(std::chrono::milliseconds duration) {
+        auto until = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < until) {
+            io.poll();
+            io.reset();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // Verbindet einen Client und wartet, bis die Sitzung angenommen ist
+    void connect(tcp::socket& client) {
+        client.connect(tcp::endpoint(asio::ip::address_v4::loopback(), static_cast<unsigned short>(cfg.stream_tcp_port)));
+        size_t before = sink.session_count();
+        auto until = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (sink.session_count() == before && std::chrono::steady_clock::now() < until) poll_for(std::chrono::milliseconds(5));
+    }
+};
+
+// Liest genau n Bytes, während der Sink weiterläuft
+std::string read_exactly(SinkFixture& f, tcp::socket& client, size_t n) {
+    std::string out;
+    client.non_blocking(true);
+    char buf[4096];
+    auto until = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (out.size() < n && std::chrono::steady_clock::now() < until) {
+        f.poll_for(std::chrono::milliseconds(1));
+        asio::error_code ec;
+        size_t got = client.read_some(asio::buffer(buf, std::min(sizeof(buf), n - out.size())), ec);
+        if (!ec) out.append(buf, got);
+    }
+    return out;
+}
+
+} // namespace
+
+// ndjson: eine Zeile pro Nachricht, in Reihenfolge
+TEST_CASE(stream_ndjson_lines_in_order) {
+    SinkFixture f("ndjson");
+    REQUIRE(f.sink.start(f.cfg));
+    tcp::socket client(f.io);
+    f.connect(client);
+    REQUIRE(f.sink.session_count() == 1);
+
+    std::string expected;
+    for (uint64_t seq = 1; seq <= 20; ++seq) {
+        f.sink.send(test::make_frame(seq));
+        expected += "{\"seq\":" + std::to_string(seq) + "}\n";
+    }
+    CHECK(read_exactly(f, client, expected.size()) == expected);
+    f.sink.stop();
+}
+
+// binary: u32-Länge + MessagePack; Frames ohne MessagePack werden nicht als JSON verschickt
+TEST_CASE(stream_binary_requires_msgpack) {
+    SinkFixture f("binary");
+    REQUIRE(f.sink.start(f.cfg));
+    tcp::socket client(f.io);
+    f.connect(client);
+
+    f.sink.send(test::make_frame(1));
+    CHECK(f.sink.frames_without_msgpack() == 1);
+    const std::string msgpack("\x81\xa3seq\x02", 6);
+    f.sink.send(test::make_frame(2, MessageKind::frame, "", msgpack));
+    std::string received = read_exactly(f, client, 4 + msgpack.size());
+    CHECK(received == std::string("\x06\x00\x00\x00", 4) + msgpack);
+    f.sink.stop();
+}
+
+// Ein Client, der nicht liest, wird an der Puffergrenze getrennt statt unbegrenzt zu puffern
+TEST_CASE(stream_disconnects_client_over_buffer_limit) {
+    SinkFixture f("ndjson", 64);
+    REQUIRE(f.sink.start(f.cfg));
+    tcp::socket stalled(f.io);
+    stalled.open(tcp::v4());
+    stalled.set_option(asio::socket_base::receive_buffer_size(4096));
+    f.connect(stalled);
+    REQUIRE(f.sink.session_count() == 1);
+
+    for (uint64_t seq = 1; seq <= 2000 && f.sink.clients_dropped() == 0; ++seq) {
+        f.sink.send(test::make_frame(seq, MessageKind::frame, test::sized_json(seq, 8 * 1024)));
+        f.poll_for(std::chrono::milliseconds(0));
+    }
+    CHECK(f.sink.clients_dropped() == 1);
+    f.sink.send(test::make_frame(9999));
+    CHECK(f.sink.session_count() == 0);
+    f.sink.stop();
+}
+
+// Pause nach accept-Fehlern: verdoppelt sich bis zur Obergrenze, Erfolg setzt sie zurück
+TEST_CASE(accept_backoff_grows_and_resets) {
+    asio::io_service io;
+    AcceptBackoff backoff(io);
+    int calls = 0;
+    backoff.retry([&] { ++calls; });
+    CHECK(backoff.delay() == AcceptBackoff::min_delay);
+    io.run();
+    io.reset();
+    CHECK(calls == 1);
+
+    for (int i = 0; i < 10; ++i) backoff.retry([&] { ++calls; });
+    CHECK(backoff.delay() == AcceptBackoff::max_delay);
+    backoff.cancel();
+    io.run();
+    io.reset();
+    CHECK(calls == 1);
+
+    backoff.retry([&] { ++calls; });
+    CHECK(backoff.delay() == AcceptBackoff::min_delay);
+    backoff.cancel();
+}
@@ -0,0 +1,85 @@
+#pragma once
+// Kleines Testgerüst ohne Abhängigkeiten: TEST_CASE registriert eine Funktion,
+// CHECK/REQUIRE melden Fehler mit Datei und Zeile. Alle Fälle laufen in
+// scs_ws_tests; ein Argument wählt Fälle aus, deren Name es enthält.
+
+#include "encoded_frame.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace test {
+
+struct Case {
+    const char* name;
+    void (*run)();
+};
+
+std::vector<Case>& registry();
+
+struct Registrar {
+    Registrar(const char* name, void (*run)()) { registry().push_back({name, run}); }
+};
+
+// Fehlschläge des laufenden Falls
+extern int failures;
+
+// REQUIRE bricht den Fall ab
+struct Abort {};
+
+// Zählt operator new im aufrufenden Thread (siehe test_main.cpp)
+uint64_t thread_allocations();
+
+// Freie Ports pro Fall, damit sich Server nacheinander nicht in die Quere kommen
+int next_port();
+
+// {"seq":N,"data":"xx..."}, mit "data" auf mindestens bytes Zeichen aufgefüllt
+inline std::string sized_json(uint64_t seq, size_t bytes) {
+    std::string json = "{\"seq\":" + std::to_string(seq) + ",\"data\":\"";
+    json.append(bytes > json.size() + 2 ? bytes - json.size() - 2 : 0, 'x');
+    json += "\"}";
+    return json;
+}
+
+// Kodierte Nachricht wie aus dem Spiel-Thread (auch für scs_ws_bench); ohne json nur {"seq":N}
+inline EncodedFramePtr make_frame(uint64_t seq, MessageKind kind = MessageKind::frame, const std::string& json = "",
+                                  const std::string& msgpack = "", bool full_state = false) {
+    auto frame = std::make_shared<EncodedFrame>();
+    frame->seq = seq;
+    frame->kind = kind;
+    frame->full_state = full_state;
+    const std::string text = json.empty() ? "{\"seq\":" + std::to_string(seq) + "}" : json;
+    frame->json.assign(text.data(), text.size());
+    frame->msgpack.assign(msgpack.data(), msgpack.size());
+    return frame;
+}
+
+} // namespace test
+
+#define TEST_CONCAT_(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT_(a, b)
+
+#define TEST_CASE(name)                                                              \
+    static void name();                                                              \
+    static test::Registrar TEST_CONCAT(name, _registrar)(#name, &name);              \
+    static void name()
+
+#define CHECK(cond)                                                                  \
+    do {                                                                             \
+        if (!(cond)) {                                                               \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++test::failures;                                                        \
+        }                                                                            \
+    } while (0)
+
+#define REQUIRE(cond)                                                                \
+    do {                                                                             \
+        if (!(cond)) {                                                               \
+            std::fprintf(stderr, "%s:%d: REQUIRE failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++test::failures;                                                        \
+            throw test::Abort();                                                     \
+        }                                                                            \
+    } while (0)
@@ -0,0 +1,52 @@
+#include "test_support.hpp"
+#include "trace_recorder.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// Puffer entstehen bei trace_start, Messpunkte allokieren nie; nicht angemeldete
+// Threads zeichnen nichts auf, trace_shutdown gibt alles frei
+TEST_CASE(trace_preallocates_buffers_and_frees_them) {
+    const std::string path = "scs_ws_tests_trace.json";
+    trace_name_thread("test main");
+    REQUIRE(trace_start(100, path));
+    REQUIRE(trace_thread_buffer() != nullptr);
+
+    const uint64_t before = test::thread_allocations();
+    for (int i = 0; i < 100; ++i) {
+        TRACE_SCOPE("unit");
+    }
+    {
+        TraceScope skipped("skipped");
+        skipped.dismiss();
+    }
+    CHECK(test::thread_allocations() == before);
+
+    std::thread stray([] {
+        TRACE_SCOPE("stray");
+        CHECK(trace_thread_buffer() == nullptr);
+    });
+    stray.join();
+
+    // Nach dem Fenster und der Nachlaufzeit schreibt trace_poll die Datei
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    trace_poll();
+    std::ifstream in(path);
+    std::stringstream content;
+    content << in.rdbuf();
+    const std::string json = content.str();
+    CHECK(json.find("\"test main\"") != std::string::npos);
+    CHECK(json.find("\"unit\"") != std::string::npos);
+    CHECK(json.find("\"skipped\"") == std::string::npos);
+    CHECK(json.find("\"stray\"") == std::string::npos);
+    in.close();
+    std::remove(path.c_str());
+
+    trace_shutdown();
+    CHECK(trace_thread_buffer() == nullptr);
+    CHECK(!trace_active());
+}
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "test_support.hpp"
+#include "udp_sink.hpp"
+#include "websocket_server.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace asio = websocketpp::lib::asio;
+using udp = asio::ip::udp;
+
+namespace {
+
+// Empfänger auf 127.0.0.1 mit Zeitlimit je Datagramm
+struct Receiver {
+    asio::io_service io;
+    udp::socket socket{io};
+    int port = 0;
+
+    Receiver() {
+        port = test::next_port();
+        socket.open(udp::v4());
+        socket.bind(udp::endpoint(asio::ip::address_v4::loopback(), static_cast<unsigned short>(port)));
+        socket.non_blocking(true);
+    }
+
+    // Leerer String, wenn bis timeout nichts ankommt
+    std::string receive(std::chrono::milliseconds timeout = std::chrono::milliseconds(500)) {
+        char buf[65536];
+        auto until = std::chrono::steady_clock::now() + timeout;
+        do {
+            asio::error_code ec;
+            size_t n = socket.receive(asio::buffer(buf), 0, ec);
+            if (!ec) return std::string(buf, n);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        } while (std::chrono::steady_clock::now() < until);
+        return std::string();
+    }
+};
+
+uint64_t read_seq(const std::string& datagram) {
+    uint64_t seq = 0;
+    for (int i = 7; i >= 0; --i) seq = (seq << 8) | static_cast<unsigned char>(datagram[8 + i]);
+    return seq;
+}
+
+} // namespace
+
+// Header und Nutzdaten kommen unverändert beim Empfänger an
+TEST_CASE(udp_sink_sends_header_and_payload) {
+    Receiver receiver;
+    asio::io_service io;
+    UdpSink sink(io);
+    PluginConfig cfg;
+    cfg.udp_targets = {"127.0.0.1:" + std::to_string(receiver.port)};
+    REQUIRE(sink.start(cfg));
+
+    const std::string json = "{\"event\":\"job.delivered\",\"revenue\":12345}";
+    sink.send(*test::make_frame(0x0102030405060708ull, MessageKind::gameplay, json));
+
+    std::string datagram = receiver.receive();
+    REQUIRE(datagram.size() == UdpSink::header_size + json.size());
+    CHECK(datagram.compare(0, 4, "SCSU") == 0);
+    CHECK(datagram[4] == 1);
+    CHECK(datagram[5] == 0);
+    CHECK(datagram[6] == static_cast<char>(MessageKind::gameplay));
+    CHECK(read_seq(datagram) == 0x0102030405060708ull);
+    CHECK(datagram.substr(UdpSink::header_size) == json);
+    CHECK(sink.datagrams_sent() == 1);
+    CHECK(sink.datagrams_dropped() == 0);
+    sink.stop();
+}
+
+// Im msgpack-Format wird der MessagePack-Puffer verschickt; fehlt er, wird verworfen
+TEST_CASE(udp_sink_msgpack_format) {
+    Receiver receiver;
+    asio::io_service io;
+    UdpSink sink(io);
+    PluginConfig cfg;
+    cfg.udp_targets = {"127.0.0.1:" + std::to_string(receiver.port)};
+    cfg.udp_format = "msgpack";
+    REQUIRE(sink.start(cfg));
+
+    const std::string msgpack("\x81\xa3seq\x07", 6);
+    sink.send(*test::make_frame(7, MessageKind::gameplay, "", msgpack));
+    std::string datagram = receiver.receive();
+    REQUIRE(datagram.size() == UdpSink::header_size + msgpack.size());
+    CHECK(datagram[5] == 1);
+    CHECK(datagram.substr(UdpSink::header_size) == msgpack);
+
+    sink.send(*test::make_frame(8, MessageKind::gameplay));
+    CHECK(receiver.receive(std::chrono::milliseconds(100)).empty());
+    CHECK(sink.datagrams_dropped() == 1);
+    sink.stop();
+}
+
+// Ungültige Ziele werden übersprungen; ohne gültiges Ziel startet der Ausgang nicht
+TEST_CASE(udp_sink_rejects_invalid_targets) {
+    asio::io_service io;
+    UdpSink sink(io);
+    PluginConfig cfg;
+    cfg.udp_targets = {"no-port", ":9000", "127.0.0.1:"};
+    CHECK(!sink.start(cfg));
+}
+
+// Über den Server: jedes Frame aus queue_broadcast landet der Reihe nach beim Empfänger
+TEST_CASE(udp_output_through_server) {
+    Receiver receiver;
+    PluginConfig cfg;
+    cfg.port = test::next_port();
+    cfg.udp_enabled = true;
+    cfg.udp_targets = {"127.0.0.1:" + std::to_string(receiver.port)};
+    WebSocketServer server;
+    REQUIRE(server.start(cfg));
+
+    for (uint64_t seq = 1; seq <= 50; ++seq) {
+        server.queue_broadcast(test::make_frame(seq, MessageKind::gameplay));
+    }
+    uint64_t expected = 1;
+    while (expected <= 50) {
+        std::string datagram = receiver.receive();
+        if (datagram.empty()) break;
+        uint64_t seq = read_seq(datagram);
+        if (seq != expected) {
+            std::fprintf(stderr, "expected seq %llu, got %llu\n", static_cast<unsigned long long>(expected),
+                         static_cast<unsigned long long>(seq));
+            CHECK(false);
+            break;
+        }
+        ++expected;
+    }
+    CHECK(expected == 51);
+    server.stop();
+}
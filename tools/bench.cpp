@@ -0,0 +1,483 @@
+// Messungen zu Durchsatz und Kosten der Pipeline, ohne Spiel:
+//
+//   scs_ws_bench              listet die Messungen
+//   scs_ws_bench <name> ...   führt die genannten aus
+//
+// Zahlen hängen stark von der Maschine ab; verglichen wird immer innerhalb
+// eines Laufs (mit/ohne, vorher/nachher).
+
+#include "test_client.hpp"
+#include "test_support.hpp"
+#include "frame_queue.hpp"
+#include "udp_sink.hpp"
+#include "websocket_server.hpp"
+#include "plugin_log.hpp"
+#include "usage_stats.hpp"
+#include "ws_config.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <websocketpp/server.hpp>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace {
+
+struct Bench {
+    const char* name;
+    const char* what;
+    void (*run)();
+};
+
+std::vector<Bench>& benches() {
+    static std::vector<Bench> list;
+    return list;
+}
+
+struct BenchRegistrar {
+    BenchRegistrar(const char* name, const char* what, void (*run)()) { benches().push_back({name, what, run}); }
+};
+
+#define BENCH(name, what)                                                    \
+    static void bench_##name();                                              \
+    static BenchRegistrar bench_##name##_registrar(#name, what, &bench_##name); \
+    static void bench_##name()
+
+int g_port = 19900;
+
+// CPU-Zeit des aufrufenden Threads in ms
+double thread_cpu_ms() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+    auto to_ms = [](const FILETIME& t) { return ((static_cast<uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime) / 10000.0; };
+    return to_ms(kernel) + to_ms(user);
+#else
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#endif
+}
+
+// CPU-Zeit der Plugin-Threads (Server, Shards) in ms, aus der usage-Nachricht
+double server_cpu_ms() {
+    nlohmann::json usage = nlohmann::json::parse(usage_message());
+    return usage["cpu"]["server"]["ms"].get<double>() + usage["cpu"]["shards"]["ms"].get<double>();
+}
+
+// Schickt frames Frames mit hz an alle Clients; liefert die CPU-Zeit der Server-Threads
+double drive(WebSocketServer& server, int frames, int hz, size_t payload_bytes,
+             const std::function<void(int)>& per_frame = nullptr) {
+    const double cpu_before = server_cpu_ms();
+    const auto step = std::chrono::microseconds(1000000 / hz);
+    auto next = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) {
+        const uint64_t seq = static_cast<uint64_t>(i) + 1;
+        server.queue_broadcast(test::make_frame(seq, MessageKind::frame, test::sized_json(seq, payload_bytes), "", true));
+        if (per_frame) per_frame(i);
+        next += step;
+        std::this_thread::sleep_until(next);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200)); // Server-Threads Proben nehmen lassen
+    return server_cpu_ms() - cpu_before;
+}
+
+} // namespace
+
+// Server-CPU pro Frame, während /metrics mit 10 Hz abgefragt wird, gegenüber metrics_enabled=0
+BENCH(metrics, "server CPU per frame with /metrics scraped at 10 Hz vs. metrics disabled") {
+    const int frames = 600;
+    const int clients = 8;
+    for (bool enabled : {false, true}) {
+        PluginConfig cfg;
+        cfg.port = g_port++;
+        cfg.metrics_enabled = enabled;
+        WebSocketServer server;
+        server.start(cfg);
+        std::vector<std::unique_ptr<test::WsClient>> viewers;
+        for (int i = 0; i < clients; ++i) {
+            viewers.emplace_back(new test::WsClient());
+            viewers.back()->connect(cfg.port);
+        }
+        double scrape_ms = 0;
+        int scrapes = 0;
+        double cpu = drive(server, frames, 60, 2048, [&](int i) {
+            if (!enabled || i % 6 != 0) return;
+            auto start = std::chrono::steady_clock::now();
+            test::http_get(cfg.port, "/metrics");
+            scrape_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            ++scrapes;
+        });
+        std::printf("metrics %-8s %d clients: server CPU %.1f us/frame", enabled ? "scraped" : "disabled", clients,
+                    cpu * 1000.0 / frames);
+        if (scrapes) std::printf(", %.2f ms per scrape", scrape_ms / scrapes);
+        std::printf("\n");
+        viewers.clear();
+        server.stop();
+    }
+}
+
+// Perzentile einer Messreihe in Nanosekunden
+void print_percentiles(const char* label, std::vector<double>& ns) {
+    std::sort(ns.begin(), ns.end());
+    auto at = [&](double q) { return ns[std::min(ns.size() - 1, static_cast<size_t>(q * ns.size()))]; };
+    std::printf("%-44s p50 %6.0f ns  p99 %6.0f ns  p99.9 %7.0f ns  max %8.0f ns\n", label, at(0.5), at(0.99), at(0.999),
+                ns.back());
+}
+
+// Latenz von FrameQueue::push() im Spiel-Thread, während der Server-Thread leert und ein zweiter Erzeuger drängelt.
+// Der Spiel-Thread schiebt alle 20 us eine Nachricht nach (weit mehr als ein Spiel erzeugt), der
+// zweite Erzeuger alle 100 us; bei Kapazität 16 läuft der Ring zwischen zwei drain() über.
+BENCH(queue, "FrameQueue push latency percentiles of the game-thread producer under contention") {
+    struct Scenario {
+        const char* label;
+        size_t capacity;
+        bool second_producer;
+    };
+    const int pushes = 100000;
+    for (const Scenario& s : {Scenario{"capacity 1024, server draining", 1024, false},
+                              Scenario{"capacity 1024, draining + 2nd producer", 1024, true},
+                              Scenario{"capacity 16 (overflowing), draining + 2nd", 16, true}}) {
+        FrameQueue queue(s.capacity, FrameQueue::Overflow::drop_oldest);
+        std::vector<EncodedFramePtr> messages;
+        for (int i = 0; i < 256; ++i) {
+            auto frame = std::make_shared<EncodedFrame>();
+            frame->kind = i % 10 == 0 ? MessageKind::gameplay : MessageKind::frame;
+            messages.push_back(frame);
+        }
+        std::atomic<bool> done{false};
+        std::thread server([&] {
+            std::vector<EncodedFramePtr> out;
+            while (!done) {
+                out.clear();
+                queue.drain(out);
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+            }
+        });
+        std::thread other;
+        if (s.second_producer) {
+            other = std::thread([&] {
+                for (size_t i = 0; !done; ++i) {
+                    queue.push(messages[i % messages.size()]);
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            });
+        }
+        std::vector<double> ns;
+        ns.reserve(pushes);
+        auto next = std::chrono::steady_clock::now();
+        for (int i = 0; i < pushes; ++i) {
+            EncodedFramePtr frame = messages[static_cast<size_t>(i) % messages.size()];
+            auto start = std::chrono::steady_clock::now();
+            queue.push(std::move(frame));
+            ns.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+            next += std::chrono::microseconds(20);
+            while (std::chrono::steady_clock::now() < next) {
+            }
+        }
+        done = true;
+        server.join();
+        if (other.joinable()) other.join();
+        print_percentiles(s.label, ns);
+        std::printf("%-44s %llu frames dropped, %llu events overflowed, %llu overflow nodes allocated\n", "",
+                    static_cast<unsigned long long>(queue.frames_dropped()),
+                    static_cast<unsigned long long>(queue.events_overflowed()),
+                    static_cast<unsigned long long>(queue.overflow_nodes_allocated()));
+    }
+}
+
+// Ein nackter websocketpp-Server mit Config, der im aufrufenden Thread läuft: clients
+// verbinden, dann broadcasts-mal dieselbe Nachricht an alle; liefert CPU-µs pro Broadcast
+template <typename Config>
+double broadcast_cost(int clients, int broadcasts, size_t payload_bytes) {
+    using server_t = websocketpp::server<Config>;
+    server_t server;
+    server.clear_access_channels(websocketpp::log::alevel::all);
+    server.clear_error_channels(websocketpp::log::elevel::all);
+    server.init_asio();
+    server.set_reuse_addr(true);
+    std::vector<websocketpp::connection_hdl> connections;
+    server.set_open_handler([&](websocketpp::connection_hdl hdl) { connections.push_back(hdl); });
+    const int port = g_port++;
+    server.listen(static_cast<uint16_t>(port));
+    server.start_accept();
+
+    std::vector<std::unique_ptr<test::WsClient>> viewers;
+    std::vector<std::thread> connecting;
+    for (int i = 0; i < clients; ++i) {
+        viewers.emplace_back(new test::WsClient());
+        test::WsClient* viewer = viewers.back().get();
+        connecting.emplace_back([viewer, port] { viewer->connect(port); });
+    }
+    while (connections.size() < static_cast<size_t>(clients)) {
+        server.poll();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (auto& t : connecting) t.join();
+
+    const std::string payload(payload_bytes, 'x');
+    const double cpu_before = thread_cpu_ms();
+    for (int b = 0; b < broadcasts; ++b) {
+        for (const auto& hdl : connections) {
+            websocketpp::lib::error_code ec;
+            server.send(hdl, payload, websocketpp::frame::opcode::text, ec);
+        }
+        server.poll();
+    }
+    // Bis alles geschrieben ist
+    for (int i = 0; i < 200; ++i) {
+        server.poll();
+        bool pending = false;
+        for (const auto& hdl : connections) {
+            websocketpp::lib::error_code ec;
+            auto con = server.get_con_from_hdl(hdl, ec);
+            if (!ec && con->get_buffered_amount() > 0) pending = true;
+        }
+        if (!pending) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const double cpu_us = (thread_cpu_ms() - cpu_before) * 1000.0 / broadcasts;
+
+    for (const auto& hdl : connections) {
+        websocketpp::lib::error_code ec;
+        server.close(hdl, websocketpp::close::status::going_away, "", ec);
+    }
+    websocketpp::lib::error_code ec;
+    server.stop_listening(ec);
+    for (int i = 0; i < 50; ++i) {
+        server.poll();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    viewers.clear();
+    server.poll();
+    return cpu_us;
+}
+
+// Server-CPU pro Broadcast: eigene websocketpp-Config (ohne Mutexe, Stub-Logger, Nachrichtenpool) gegenüber der Standard-Config
+BENCH(config, "server-thread CPU per broadcast to 8 clients: scs_ws::server_config vs. stock websocketpp config") {
+    const int clients = 8;
+    const int broadcasts = 3000;
+    for (size_t payload : {size_t(256), size_t(4096)}) {
+        // Abwechselnd, jeweils das beste von fünf Läufen (die Clients laufen auf denselben Kernen)
+        double stock = 1e9;
+        double custom = 1e9;
+        for (int run = 0; run < 5; ++run) {
+            stock = std::min(stock, broadcast_cost<websocketpp::config::asio>(clients, broadcasts, payload));
+            custom = std::min(custom, broadcast_cost<scs_ws::server_config>(clients, broadcasts, payload));
+        }
+        std::printf("config %5zu B x %d clients: stock %.1f us, scs_ws %.1f us per broadcast (%.0f%%)\n", payload,
+                    clients, stock, custom, custom * 100.0 / stock);
+    }
+}
+
+// Server-CPU pro Frame für Stream-Clients (TCP, ndjson) gegenüber WebSocket-Clients
+BENCH(stream, "server CPU per frame for 8 raw TCP stream clients vs. 8 WebSocket clients, 60 Hz") {
+    namespace asio = websocketpp::lib::asio;
+    const int frames = 600;
+    const int clients = 8;
+    for (bool stream : {false, true}) {
+        PluginConfig cfg;
+        cfg.port = g_port++;
+        if (stream) cfg.stream_tcp_port = g_port++;
+        WebSocketServer server;
+        server.start(cfg);
+
+        std::vector<std::unique_ptr<test::WsClient>> viewers;
+        asio::io_service io;
+        std::vector<std::unique_ptr<asio::ip::tcp::socket>> sockets;
+        std::atomic<bool> done{false};
+        std::thread reader;
+        if (stream) {
+            for (int i = 0; i < clients; ++i) {
+                sockets.emplace_back(new asio::ip::tcp::socket(io));
+                sockets.back()->connect(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(),
+                                                                static_cast<unsigned short>(cfg.stream_tcp_port)));
+                sockets.back()->non_blocking(true);
+            }
+            reader = std::thread([&] {
+                std::vector<char> buf(65536);
+                while (!done) {
+                    for (auto& socket : sockets) {
+                        asio::error_code ec;
+                        while (!ec) socket->read_some(asio::buffer(buf), ec);
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            });
+        } else {
+            for (int i = 0; i < clients; ++i) {
+                viewers.emplace_back(new test::WsClient());
+                viewers.back()->connect(cfg.port);
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        double cpu = drive(server, frames, 60, 2048);
+        std::printf("stream %-9s %d clients: server CPU %.1f us/frame\n", stream ? "tcp" : "websocket", clients,
+                    cpu * 1000.0 / frames);
+        done = true;
+        if (reader.joinable()) reader.join();
+        viewers.clear();
+        server.stop();
+    }
+}
+
+// Datagramme pro Sekunde und Sendekosten des UDP-Ausgangs über Loopback
+BENCH(udp, "UDP datagrams per second and send cost over loopback, 1 KB and 8 KB payloads") {
+    namespace asio = websocketpp::lib::asio;
+    using udp = asio::ip::udp;
+    for (size_t payload : {size_t(1024), size_t(8192)}) {
+        asio::io_service io;
+        udp::socket receiver(io);
+        receiver.open(udp::v4());
+        receiver.set_option(asio::socket_base::receive_buffer_size(4 << 20));
+        receiver.bind(udp::endpoint(asio::ip::address_v4::loopback(), 0));
+        const unsigned short port = receiver.local_endpoint().port();
+
+        std::atomic<bool> done{false};
+        std::atomic<uint64_t> received{0};
+        std::thread reader([&] {
+            receiver.non_blocking(true);
+            std::vector<char> buf(65536);
+            while (!done) {
+                asio::error_code ec;
+                receiver.receive(asio::buffer(buf), 0, ec);
+                if (!ec) received.fetch_add(1, std::memory_order_relaxed);
+                else std::this_thread::yield();
+            }
+        });
+
+        UdpSink sink(io);
+        PluginConfig cfg;
+        cfg.udp_targets = {"127.0.0.1:" + std::to_string(port)};
+        sink.start(cfg);
+        const int frames = 100000;
+        std::vector<EncodedFramePtr> prepared;
+        for (int i = 0; i < 64; ++i) {
+            const uint64_t seq = static_cast<uint64_t>(i);
+            prepared.push_back(test::make_frame(seq, MessageKind::frame, test::sized_json(seq, payload), "", true));
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; ++i) sink.send(*prepared[static_cast<size_t>(i) % prepared.size()]);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        done = true;
+        reader.join();
+        std::printf("udp %5zu B: %.0f datagrams/s (%.1f MB/s), %.2f us per send, sent %llu, dropped %llu, received %llu\n",
+                    payload, frames / seconds, frames * (payload + UdpSink::header_size) / seconds / 1e6,
+                    seconds * 1e6 / frames, static_cast<unsigned long long>(sink.datagrams_sent()),
+                    static_cast<unsigned long long>(sink.datagrams_dropped()),
+                    static_cast<unsigned long long>(received.load()));
+        sink.stop();
+    }
+}
+
+// Kosten eines PLOG-Aufrufs für den Aufrufer (Spiel-Thread). Zwischen den
+// Runden wird geleert, damit der Ring nie voll ist und nur der Normalfall zählt.
+BENCH(log, "per-call producer cost of PLOG_* in text and binary format, and below the level threshold") {
+    const int rounds = 200;
+    const int per_round = 500;
+    std::vector<double> ns;
+    ns.reserve(rounds * per_round);
+    auto measure = [&](const char* label, const std::function<void(int)>& call) {
+        ns.clear();
+        for (int r = 0; r < rounds; ++r) {
+            for (int i = 0; i < per_round; ++i) {
+                auto start = std::chrono::steady_clock::now();
+                call(i);
+                ns.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+            }
+            plugin_log_flush();
+        }
+        print_percentiles(label, ns);
+    };
+    const uint64_t dropped_before = plugin_log_dropped();
+    for (bool binary : {false, true}) {
+        plugin_log_configure(binary, 0, 3);
+        measure(binary ? "log binary PLOG_INFO (3 args)" : "log text PLOG_INFO (3 args)", [](int i) {
+            PLOG_INFO(ws, "Client connected (shard %d). Clients on shard: %zu, %s", i & 3, static_cast<size_t>(i), "bench");
+        });
+    }
+    plugin_log_configure(false, 0, 3);
+    measure("log PLOG_DEBUG below threshold", [](int i) {
+        PLOG_DEBUG(ws, "Client connected (shard %d). Clients on shard: %zu, %s", i & 3, static_cast<size_t>(i), "bench");
+    });
+    std::printf("log: %llu lines dropped\n", static_cast<unsigned long long>(plugin_log_dropped() - dropped_before));
+}
+
+// Verteilung der Clients auf 1-4 io-Threads. Gemessen wird die CPU aller
+// Server-Threads pro Frame und die Zeit, bis ein Frame bei allen Clients angekommen ist.
+// Auf einer Maschine mit weniger Kernen als Threads ist kein Gewinn zu erwarten.
+BENCH(threads, "server CPU per frame and fan-out latency to 32 clients with ws_threads 1-4") {
+    const int clients = 32;
+    const int frames = 600;
+    const size_t payload = 4096;
+    std::printf("threads: %u hardware threads\n", std::thread::hardware_concurrency());
+    for (int threads = 1; threads <= 4; ++threads) {
+        PluginConfig cfg;
+        cfg.port = g_port++;
+        cfg.ws_threads = threads;
+        cfg.max_connections = 0;
+        WebSocketServer server;
+        server.start(cfg);
+        std::vector<std::unique_ptr<test::WsClient>> viewers;
+        for (int i = 0; i < clients; ++i) {
+            viewers.emplace_back(new test::WsClient());
+            viewers.back()->connect(cfg.port);
+        }
+        const double cpu = drive(server, frames, 60, payload);
+
+        std::vector<double> fanout_ns;
+        for (int i = 0; i < 50; ++i) {
+            std::vector<size_t> before;
+            for (auto& v : viewers) before.push_back(v->message_count());
+            auto start = std::chrono::steady_clock::now();
+            const uint64_t seq = static_cast<uint64_t>(frames + i) + 1;
+            server.queue_broadcast(test::make_frame(seq, MessageKind::frame, test::sized_json(seq, payload), "", true));
+            for (size_t c = 0; c < viewers.size();) {
+                if (viewers[c]->message_count() > before[c]) {
+                    ++c;
+                } else if (std::chrono::steady_clock::now() - start > std::chrono::seconds(1)) {
+                    break;
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            }
+            fanout_ns.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+        }
+        std::printf("threads %d: server CPU %.1f us/frame\n", threads, cpu * 1000.0 / frames);
+        char label[64];
+        std::snprintf(label, sizeof(label), "threads %d: fan-out to %d clients", threads, clients);
+        print_percentiles(label, fanout_ns);
+        viewers.clear();
+        server.stop();
+    }
+}
+
+int main(int argc, char** argv) {
+    plugin_log_init("scs_ws_bench.log");
+    if (argc < 2) {
+        for (const Bench& b : benches()) std::printf("%-10s %s\n", b.name, b.what);
+    }
+    for (int i = 1; i < argc; ++i) {
+        for (const Bench& b : benches()) {
+            if (std::strcmp(argv[i], b.name) == 0) b.run();
+        }
+    }
+    plugin_log_close();
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Wandelt die binäre Logdatei des Plugins (log_format=binary) wieder in Text um,
+// im selben Format wie plugin_debug.log.
+//
+//   log_decode plugin_debug.binlog [plugin_debug.binlog.1 ...]
+//
+// Braucht nur src/log_format.hpp, z.B. cl /std:c++17 /EHsc /I..\src log_decode.cpp
+
+#include "log_format.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct Format {
+    uint8_t level;
+    std::string tag;
+    std::string fmt;
+};
+
+const char* const level_columns[] = {"TRACE ", "DEBUG ", "INFO  ", "WARN  ", "ERROR ", "      "};
+
+template <typename T>
+bool read(const std::vector<char>& data, size_t& at, T& value) {
+    if (at + sizeof(T) > data.size()) return false;
+    std::memcpy(&value, data.data() + at, sizeof(T));
+    at += sizeof(T);
+    return true;
+}
+
+bool read_bytes(const std::vector<char>& data, size_t& at, size_t n, std::string& out) {
+    if (at + n > data.size()) return false;
+    out.assign(data.data() + at, n);
+    at += n;
+    return true;
+}
+
+void print_time(int64_t time_us) {
+    std::time_t t = static_cast<std::time_t>(time_us / 1000000);
+    std::tm tm_local{};
+#ifdef _WIN32
+    localtime_s(&tm_local, &t);
+#else
+    localtime_r(&t, &tm_local);
+#endif
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm_local);
+    std::printf("%s.%03d ", stamp, static_cast<int>((time_us / 1000) % 1000));
+}
+
+bool decode(const char* path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() < sizeof(binlog::magic) + 1 || std::memcmp(data.data(), binlog::magic, sizeof(binlog::magic)) != 0) {
+        std::fprintf(stderr, "%s: not a binary plugin log\n", path);
+        return false;
+    }
+    if (static_cast<uint8_t>(data[sizeof(binlog::magic)]) != binlog::version) {
+        std::fprintf(stderr, "%s: unsupported version %u\n", path, static_cast<unsigned>(static_cast<uint8_t>(data[sizeof(binlog::magic)])));
+        return false;
+    }
+
+    std::unordered_map<uint16_t, Format> formats;
+    size_t at = sizeof(binlog::magic) + 1;
+    std::string text;
+    while (at < data.size()) {
+        uint8_t type;
+        uint16_t id;
+        if (!read(data, at, type) || !read(data, at, id)) break;
+        if (type == binlog::record_format) {
+            Format f;
+            uint8_t tag_len;
+            uint16_t fmt_len;
+            if (!read(data, at, f.level) || !read(data, at, tag_len) || !read_bytes(data, at, tag_len, f.tag) ||
+                !read(data, at, fmt_len) || !read_bytes(data, at, fmt_len, f.fmt)) {
+                break;
+            }
+            if (f.level > 5) f.level = 5;
+            formats[id] = std::move(f);
+        } else if (type == binlog::record_entry) {
+            int64_t time_us;
+            uint16_t args_len;
+            if (!read(data, at, time_us) || !read(data, at, args_len) || at + args_len > data.size()) break;
+            const char* args = data.data() + at;
+            at += args_len;
+
+            print_time(time_us);
+            auto it = formats.find(id);
+            if (it == formats.end()) {
+                std::printf("?     [?] <unknown format %u>\n", static_cast<unsigned>(id));
+                continue;
+            }
+            text.clear();
+            binlog::format_args(it->second.fmt.c_str(), args, args_len, text);
+            std::printf("%s[%s] %s\n", level_columns[it->second.level], it->second.tag.c_str(), text.c_str());
+        } else {
+            std::fprintf(stderr, "%s: unknown record type %u at offset %zu\n", path, static_cast<unsigned>(type), at - 3);
+            return false;
+        }
+    }
+    if (at < data.size()) {
+        std::fprintf(stderr, "%s: truncated record at offset %zu\n", path, at);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s plugin_debug.binlog [more.binlog ...]\n", argv[0]);
+        return 2;
+    }
+    bool ok = true;
+    for (int i = 1; i < argc; ++i) ok = decode(argv[i]) && ok;
+    return ok ? 0 : 1;
+}